@@ -1,3 +1,9 @@
  
 # https://github.com/rjricken/monkey-moore/issues/1
-g++ src/*.cpp -o build/mmoore  `wx-config --cflags --libs` -std=c++11 -Wfatal-errors -Wwrite-strings -fpermissive
+g++ $(ls src/*.cpp | grep -v monkey_cli.cpp) -o build/mmoore  `wx-config --cflags --libs` -DMONKEY_WITH_ZLIB -lz -std=c++17 -Wfatal-errors -Wwrite-strings -fpermissive
+
+# command line version, which only needs wxBase
+g++ src/monkey_cli.cpp -o build/mmoore-cli  `wx-config --cflags --libs base` -DMONKEY_WITH_ZLIB -lz -std=c++17 -Wfatal-errors -Wwrite-strings -fpermissive
+
+# core search benchmark
+g++ -O2 test/MonkeyMooreBench/monkey_bench.cpp -Isrc -o build/mmoore-bench -std=c++17 -Wfatal-errors -Wwrite-strings -fpermissive
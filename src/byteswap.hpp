@@ -19,16 +19,7 @@
 #ifndef BYTESWAP_HPP
 #define BYTESWAP_HPP
 
-#include <wx/wxprec.h>
-
-#ifdef __BORLANDC__
-   #pragma hdrstop
-#endif
-
-#ifndef WX_PRECOMP
-   #include <wx/wx.h>
-#endif
-
+#include <cstddef>
 #include <cstdint>
 
 /*
@@ -49,42 +40,67 @@
 
 */
 
-template <typename _DataType> _DataType swap_always (_DataType val);
-template <typename _DataType> _DataType swap_on_le (_DataType val);
-template <typename _DataType> _DataType swap_on_be (_DataType val);
+// the system endianness, as the compiler sees it (Windows only runs little endian)
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+   #define MONKEY_BIG_ENDIAN_SYSTEM 1
+#else
+   #define MONKEY_BIG_ENDIAN_SYSTEM 0
+#endif
+
+template <typename _DataType> constexpr _DataType swap_always (_DataType val);
+template <typename _DataType> constexpr _DataType swap_on_le (_DataType val);
+template <typename _DataType> constexpr _DataType swap_on_be (_DataType val);
 
 
 // template specializations for swap_always
-template <> inline uint8_t swap_always<uint8_t> (uint8_t val)
+// (compilers turn these into a single byte swap instruction)
+template <> constexpr uint8_t swap_always<uint8_t> (uint8_t val)
 { return val; }
 
-template <> inline uint16_t swap_always<uint16_t> (uint16_t val)
-{ return wxUINT16_SWAP_ALWAYS(val); }
+template <> constexpr uint16_t swap_always<uint16_t> (uint16_t val)
+{ return static_cast <uint16_t> ((val >> 8) | (val << 8)); }
 
-template <> inline uint32_t swap_always<uint32_t> (uint32_t val)
-{ return wxUINT32_SWAP_ALWAYS(val); }
+template <> constexpr uint32_t swap_always<uint32_t> (uint32_t val)
+{ return (val >> 24) | ((val >> 8) & 0x0000FF00u) | ((val << 8) & 0x00FF0000u) | (val << 24); }
 
 
 // template specializations for swap_on_le
-template <> inline uint8_t swap_on_le<uint8_t> (uint8_t val)
+template <> constexpr uint8_t swap_on_le<uint8_t> (uint8_t val)
 { return val; }
 
-template <> inline uint16_t swap_on_le<uint16_t> (uint16_t val)
-{ return wxUINT16_SWAP_ON_LE(val); }
+template <> constexpr uint16_t swap_on_le<uint16_t> (uint16_t val)
+{ return MONKEY_BIG_ENDIAN_SYSTEM ? val : swap_always<uint16_t>(val); }
 
-template <> inline uint32_t swap_on_le<uint32_t> (uint32_t val)
-{ return wxUINT32_SWAP_ON_LE(val); }
+template <> constexpr uint32_t swap_on_le<uint32_t> (uint32_t val)
+{ return MONKEY_BIG_ENDIAN_SYSTEM ? val : swap_always<uint32_t>(val); }
 
 
 // template specializations for swap_on_be
-template <> inline uint8_t swap_on_be<uint8_t> (uint8_t val)
+template <> constexpr uint8_t swap_on_be<uint8_t> (uint8_t val)
 { return val; }
 
-template <> inline uint16_t swap_on_be<uint16_t> (uint16_t val)
-{ return wxUINT16_SWAP_ON_BE(val); }
+template <> constexpr uint16_t swap_on_be<uint16_t> (uint16_t val)
+{ return MONKEY_BIG_ENDIAN_SYSTEM ? swap_always<uint16_t>(val) : val; }
+
+template <> constexpr uint32_t swap_on_be<uint32_t> (uint32_t val)
+{ return MONKEY_BIG_ENDIAN_SYSTEM ? swap_always<uint32_t>(val) : val; }
+
+
+// values of narrower widths kept on a wider type (ie: results of searches over
+// every width at once), wrapped around and swapped within their own width
+template <typename _DataType> constexpr _DataType swap_on_le (_DataType val, size_t width)
+{
+   return width == 1 ? static_cast <_DataType> (static_cast <uint8_t> (val)) :
+      width == 2 ? static_cast <_DataType> (swap_on_le<uint16_t>(static_cast <uint16_t> (val))) :
+      static_cast <_DataType> (swap_on_le<uint32_t>(static_cast <uint32_t> (val)));
+}
 
-template <> inline uint32_t swap_on_be<uint32_t> (uint32_t val)
-{ return wxUINT32_SWAP_ON_BE(val); }
+template <typename _DataType> constexpr _DataType swap_on_be (_DataType val, size_t width)
+{
+   return width == 1 ? static_cast <_DataType> (static_cast <uint8_t> (val)) :
+      width == 2 ? static_cast <_DataType> (swap_on_be<uint16_t>(static_cast <uint16_t> (val))) :
+      static_cast <_DataType> (swap_on_be<uint32_t>(static_cast <uint32_t> (val)));
+}
 
 
 #endif //~BYTESWAP_HPP
@@ -72,6 +72,7 @@ enum
    MonkeyMoore_8bitMode,
    MonkeyMoore_16bitMode,
    MonkeyMoore_32bitMode,
+   MonkeyMoore_AutoWidthMode,
    MonkeyMoore_Advanced,
    MonkeyMoore_EnableCP,
    MonkeyMoore_CharPattern,
@@ -79,6 +80,7 @@ enum
    MonkeyMoore_EnableByteOrder,
    MonkeyMoore_ByteOrderLE,
    MonkeyMoore_ByteOrderBE,
+   MonkeyMoore_ByteOrderBoth,
    MonkeyMoore_AllResults,
    MonkeyMoore_Results,
    MonkeyMoore_CreateTbl,
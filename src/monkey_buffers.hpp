@@ -0,0 +1,126 @@
+/*
+ * Monkey-Moore - A simple and powerful relative search tool
+ * Copyright (C) 2007 Ricardo J. Ricken (Darkl0rd)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef MONKEY_BUFFERS_HPP
+#define MONKEY_BUFFERS_HPP
+
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+/**
+* Fixed set of equally sized buffers, carved out of a single allocation and
+* recycled: a buffer goes back to the pool as soon as its last shared_ptr is gone.
+* Acquiring blocks while every buffer is in use, so whoever fills them (ie: the
+* thread reading the file) can't get ahead of whoever releases them, and the
+* memory taken stays the same for the whole search.
+*/
+class BufferPool
+{
+public:
+   enum { alignment = 64 };  /**< buffers start on cache line (and SIMD register) boundaries */
+
+   /**
+   * Constructor. Allocates every buffer at once.
+   * @param count number of buffers
+   * @param size bytes in each buffer (rounded up to the alignment)
+   */
+   BufferPool (size_t count, size_t size) :
+   m_count(count), m_size((size + alignment - 1) & ~static_cast<size_t>(alignment - 1)), m_arena(0)
+   {
+      if (!m_count || !m_size)
+         return;
+
+      m_arena = static_cast<uint8_t *>(::operator new(m_count * m_size, std::align_val_t(alignment)));
+
+      for (size_t i = 0; i < m_count; ++i)
+         m_free.push_back(m_arena + i * m_size);
+   }
+
+   /**
+   * Destructor. Every buffer must have been released by then.
+   */
+   ~BufferPool ()
+   {
+      assert(m_free.size() == m_count || !m_arena);
+
+      if (m_arena)
+         ::operator delete(m_arena, std::align_val_t(alignment));
+   }
+
+   /**
+   * Takes a buffer, blocking the caller until one is free.
+   * @return The buffer, which returns to the pool when its last owner lets it go.
+   */
+   std::shared_ptr<uint8_t> Acquire ()
+   {
+      assert(m_arena != 0);
+
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_released.wait(lock, [this] { return !m_free.empty(); });
+
+      uint8_t *buffer = m_free.back();
+      m_free.pop_back();
+
+      return std::shared_ptr<uint8_t>(buffer, [this] (uint8_t *b) { Release(b); });
+   }
+
+   /**
+   * Returns the size of the buffers.
+   * @return Bytes in each buffer.
+   */
+   size_t GetBufferSize () const { return m_size; }
+
+   /**
+   * Returns the number of buffers.
+   * @return Number of buffers, in use or not.
+   */
+   size_t GetCount () const { return m_count; }
+
+   BufferPool (const BufferPool &) = delete;
+   BufferPool &operator= (const BufferPool &) = delete;
+
+private:
+   /**
+   * Puts a buffer back in the pool, waking up whoever is waiting for one.
+   * @param buffer the buffer
+   */
+   void Release (uint8_t *buffer)
+   {
+      {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         m_free.push_back(buffer);
+      }
+
+      m_released.notify_one();
+   }
+
+   const size_t m_count;                  /**< number of buffers               */
+   const size_t m_size;                   /**< bytes in each buffer            */
+   uint8_t *m_arena;                      /**< memory of every buffer          */
+
+   std::vector<uint8_t *> m_free;         /**< buffers not in use              */
+   std::mutex m_mutex;                    /**< guards the free buffers         */
+   std::condition_variable m_released;    /**< signaled when a buffer is freed */
+};
+
+#endif //~MONKEY_BUFFERS_HPP
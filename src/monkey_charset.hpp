@@ -0,0 +1,117 @@
+/*
+ * Monkey-Moore - A simple and powerful relative search tool
+ * Copyright (C) 2007 Ricardo J. Ricken (Darkl0rd)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef MONKEY_CHARSET_HPP
+#define MONKEY_CHARSET_HPP
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+/**
+* Maps the characters of a custom character set to their positions.
+*
+* Sets made of a single Unicode block (ie: hiragana) are looked up directly, by
+* the distance to their lowest character. Sparse ones (ie: kana and ASCII mixed)
+* would waste too much memory that way, so they use a perfect hash instead: the
+* smallest table size on which no two characters land on the same slot.
+*/
+class charset_index
+{
+public:
+   /**
+   * Constructor. Creates an empty index.
+   */
+   charset_index () : base(0), hashed(false) { }
+
+   /**
+   * Builds the index for the given character set.
+   * Repeated characters get the last of their positions.
+   * @param set custom character set
+   */
+   void assign (const std::vector <char32_t> &set)
+   {
+      slots.clear();
+      hashed = false;
+
+      if (set.empty())
+         return;
+
+      const auto bounds = std::minmax_element(set.begin(), set.end());
+      base = static_cast <size_t> (*bounds.first);
+
+      const size_t span = static_cast <size_t> (*bounds.second) - base + 1;
+      size_t size = span;
+
+      // too sparse for a direct table, so look for a collision free size. any size
+      // over the distance between the first and last characters is, so it's bounded.
+      if (span > std::max <size_t> (dense_limit, set.size() * 4))
+      {
+         hashed = true;
+
+         std::vector <char32_t> unique(set);
+         std::sort(unique.begin(), unique.end());
+         unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+
+         std::vector <bool> used;
+
+         for (size = unique.size(); size < span; size++)
+         {
+            used.assign(size, false);
+
+            auto i = unique.begin();
+            for (; i != unique.end() && !used[(static_cast <size_t> (*i) - base) % size]; ++i)
+               used[(static_cast <size_t> (*i) - base) % size] = true;
+
+            if (i == unique.end())
+               break;
+         }
+      }
+
+      slots.assign(size, std::make_pair(static_cast <char32_t> (0), -1));
+
+      for (size_t i = 0; i < set.size(); i++)
+         slots[(static_cast <size_t> (set[i]) - base) % size] = std::make_pair(set[i], static_cast <int> (i));
+   }
+
+   /**
+   * Looks up the position of a character.
+   * @param c character
+   * @return Its position in the set, or 0 if it's not part of it.
+   */
+   int operator[] (char32_t c) const
+   {
+      size_t slot = static_cast <size_t> (c) - base;
+
+      if (hashed)
+         slot %= slots.size();
+      else if (slot >= slots.size())
+         return 0;
+
+      return slots[slot].first == c && slots[slot].second >= 0 ? slots[slot].second : 0;
+   }
+
+private:
+   enum { dense_limit = 256 };  /**< sets spanning up to this are always direct */
+
+   std::vector <std::pair <char32_t, int>> slots;  /**< character, position (-1 if free) */
+   size_t base;   /**< lowest character of the set */
+   bool hashed;   /**< slots are picked by hashing */
+};
+
+#endif //~MONKEY_CHARSET_HPP
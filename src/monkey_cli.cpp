@@ -0,0 +1,431 @@
+/*
+ * Monkey-Moore - A simple and powerful relative search tool
+ * Copyright (C) 2007 Ricardo J. Ricken (Darkl0rd)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+   Command line version of Monkey-Moore. It runs the very same search engine
+   used by the user interface, printing the results to the standard output
+   (one per line, tab separated), so it can be used on scripts and servers.
+   Directories and lists of files are searched as a batch, sharing the workers.
+*/
+
+#include "monkey_engine.hpp"
+
+#include <wx/init.h>
+#include <wx/cmdline.h>
+#include <wx/crt.h>
+#include <wx/dir.h>
+#include <csignal>
+#include <functional>
+#include <mutex>
+
+namespace
+{
+   volatile std::sig_atomic_t interrupted = 0;
+
+   /**
+   * Stops the search when the user presses CTRL+C.
+   * @param sig not used
+   */
+   extern "C" void OnInterrupt (int)
+   {
+      interrupted = 1;
+   }
+
+   /**
+   * Reports the search progress on the standard error, when asked to.
+   */
+   class ConsoleObserver : public SearchObserver
+   {
+   public:
+      explicit ConsoleObserver (bool verbose) : m_verbose(verbose), m_aborted(false) { }
+
+      virtual void OnSearchUpdate (const wxString &msg, int progress)
+      {
+         if (m_verbose)
+            wxFprintf(stderr, wxT("\r%s %3d%%"), msg, progress);
+      }
+
+      virtual void OnSearchCompleted ()
+      {
+         if (m_verbose)
+            wxFprintf(stderr, wxT("\n"));
+      }
+
+      virtual void OnSearchAborted ()
+      {
+         m_aborted = true;
+         wxFprintf(stderr, wxT("\nSearch was aborted.\n"));
+      }
+
+      virtual bool IsSearchAborted () { return interrupted != 0; }
+
+      virtual void OnFileCompleted (size_t index)
+      {
+         lock_guard<mutex> lock(m_outputMutex);
+
+         if (m_fileCompleted)
+            m_fileCompleted(index);
+      }
+
+      bool WasAborted () const { return m_aborted; }
+
+      /**
+      * Sets what's done with each file of a batch search, as soon as it's done.
+      * Calls are serialized, so the output of different files isn't mixed up.
+      * @param callback receives the file index
+      */
+      void SetFileCompleted (function<void (size_t)> callback) { m_fileCompleted = callback; }
+
+   private:
+      bool m_verbose;
+      bool m_aborted;
+
+      function<void (size_t)> m_fileCompleted;
+      mutex m_outputMutex;
+   };
+
+   /**
+   * Prints search results, one per line.
+   * @tparam _Type Basic underlying type used to represent the data
+   * @param results search results
+   * @param p search parameters
+   * @param hexOffsets prints the offsets in hexadecimal
+   * @param prefix printed before each result (ie: the file name on batch searches)
+   */
+   template <typename _Type>
+   void PrintResults (const vector<typename SearchEngine<_Type>::result_type> &results, const SearchParameters &p, bool hexOffsets, const wxString &prefix)
+   {
+      const bool relative = p.search_type == SearchParameters::relative;
+      const bool manyKeywords = relative && p.keywords.size() > 1;
+      const bool bothEndians = sizeof(_Type) > 1 && p.endianness == SearchParameters::both_endian;
+
+      for (auto i = results.begin(); i != results.end(); ++i)
+      {
+         wxString line = prefix + wxString::Format(hexOffsets ? wxT("0x%llX") : wxT("%lld"), static_cast<long long>(get<0>(*i)));
+
+         if (p.all_widths)
+            line += wxString::Format(wxT("\t%d"), get<5>(*i) * 8);
+
+         // single byte data has no byte order
+         if (bothEndians)
+            line += get<5>(*i) == 1 ? wxT("\t-") : get<4>(*i) == SearchParameters::little_endian ? wxT("\tLE") : wxT("\tBE");
+
+         if (manyKeywords)
+            line += wxT("\t") + p.keywords[get<3>(*i)];
+
+         if (relative)
+         {
+            wxString values;
+            const auto table = get<1>(*i).expand();
+            const wxString valueFmt = wxString::Format(wxT("%%c=%%0%uX"), static_cast<unsigned int>(get<5>(*i) * 2));
+
+            for (auto j = table.begin(); j != table.end(); ++j)
+            {
+               // values are shown the way they're stored in the file
+               _Type value = get<4>(*i) == SearchParameters::little_endian ?
+                  swap_on_le<_Type>(j->second, get<5>(*i)) : swap_on_be<_Type>(j->second, get<5>(*i));
+               values += (values.empty() ? wxT("") : wxT(" ")) + wxString::Format(valueFmt, static_cast<wxChar>(j->first), value);
+            }
+
+            line += wxT("\t") + values;
+         }
+
+         line += wxT("\t") + get<2>(*i);
+         wxPrintf(wxT("%s\n"), line);
+      }
+   }
+
+   /**
+   * Writes the timing and throughput counters of a search, in JSON.
+   * @param stats search counters
+   * @param name file written to ("-" for the standard error)
+   */
+   void WriteStats (const SearchStats &stats, const wxString &name)
+   {
+      const std::string json = stats.ToJson();
+
+      if (name == wxT("-"))
+         fputs(json.c_str(), stderr);
+      else
+      {
+         wxFile out;
+
+         if (!out.Create(name, true) || !out.Write(json.data(), json.size()))
+            wxFprintf(stderr, wxT("Couldn't write the search stats to %s.\n"), name);
+      }
+   }
+
+   /**
+   * Runs the search and prints the results.
+   * @tparam _Type Basic underlying type used to represent the data
+   * @param p search parameters
+   * @param files files of a batch search (empty to search the file in the parameters)
+   * @param settings search settings
+   * @param verbose shows the progress
+   * @param hexOffsets prints the offsets in hexadecimal
+   * @param statsFile where the search counters are written to (empty for nowhere)
+   * @return Process exit code.
+   */
+   template <typename _Type>
+   int RunSearch (SearchParameters &p, const vector<wxString> &files, const SearchSettings &settings, bool verbose, bool hexOffsets, const wxString &statsFile)
+   {
+      ConsoleObserver observer(verbose);
+
+      if (files.empty())
+      {
+         vector<typename SearchEngine<_Type>::result_type> unused;
+         SearchEngine<_Type> engine(p, unused, settings, observer);
+
+         // results are printed as they're found, in file offset order, and never kept
+         engine.SetResultSink([&] (vector<typename SearchEngine<_Type>::result_type> &results) {
+            PrintResults<_Type>(results, p, hexOffsets, wxEmptyString);
+         });
+
+         engine.Run();
+
+         if (!statsFile.empty())
+            WriteStats(engine.GetStats(), statsFile);
+
+         if (observer.WasAborted())
+            return 2;
+      }
+      else
+      {
+         vector<vector<typename SearchEngine<_Type>::result_type>> results;
+
+         // each file is printed as soon as it's done, then its results are dropped
+         observer.SetFileCompleted([&] (size_t index) {
+            PrintResults<_Type>(results[index], p, hexOffsets, files[index] + wxT("\t"));
+            vector<typename SearchEngine<_Type>::result_type>().swap(results[index]);
+         });
+
+         SearchEngine<_Type> engine(p, files, results, settings, observer);
+         engine.Run();
+
+         if (!statsFile.empty())
+            WriteStats(engine.GetStats(), statsFile);
+
+         if (observer.WasAborted())
+            return 2;
+      }
+
+      return 0;
+   }
+}
+
+int main (int argc, char **argv)
+{
+   wxInitializer initializer(argc, argv);
+
+   if (!initializer.IsOk())
+   {
+      fprintf(stderr, "Failed to initialize wxWidgets.\n");
+      return 1;
+   }
+
+   static const wxCmdLineEntryDesc cmdLineDesc[] =
+   {
+      { wxCMD_LINE_SWITCH, "h", "help", "show this help message", wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+      { wxCMD_LINE_OPTION, "k", "keyword", "keywords to search for, separated by commas (relative search)", wxCMD_LINE_VAL_STRING, 0 },
+      { wxCMD_LINE_OPTION, "s", "values", "values to search for, separated by spaces or commas (value scan relative)", wxCMD_LINE_VAL_STRING, 0 },
+      { wxCMD_LINE_OPTION, "w", "wildcard", "wildcard character", wxCMD_LINE_VAL_STRING, 0 },
+      { wxCMD_LINE_OPTION, "c", "charset", "custom character sequence", wxCMD_LINE_VAL_STRING, 0 },
+      { wxCMD_LINE_OPTION, "b", "bits", "data width: 8, 16 or 32 (default: 8)", wxCMD_LINE_VAL_NUMBER, 0 },
+      { wxCMD_LINE_SWITCH, "A", "all-widths", "searches 8, 16 and 32-bit data at once, reading the files only once: results are tagged with their width", wxCMD_LINE_VAL_NONE, 0 },
+      { wxCMD_LINE_SWITCH, "B", "big-endian", "multi-byte data is big endian", wxCMD_LINE_VAL_NONE, 0 },
+      { wxCMD_LINE_SWITCH, "E", "any-endian", "multi-byte data may be either endian: both are searched at once, and results are tagged LE or BE", wxCMD_LINE_VAL_NONE, 0 },
+      { wxCMD_LINE_OPTION, "t", "threads", "search threads (default: one per hardware thread)", wxCMD_LINE_VAL_NUMBER, 0 },
+      { wxCMD_LINE_OPTION, "m", "memory", "memory used by the search buffers, in MB (default: 8)", wxCMD_LINE_VAL_NUMBER, 0 },
+      { wxCMD_LINE_OPTION, "p", "preview", "characters shown in each preview (default: 40)", wxCMD_LINE_VAL_NUMBER, 0 },
+      { wxCMD_LINE_SWITCH, "d", "decimal", "prints the offsets in decimal", wxCMD_LINE_VAL_NONE, 0 },
+      { wxCMD_LINE_SWITCH, "R", "raw", "searches compressed files as they are, instead of decompressing them", wxCMD_LINE_VAL_NONE, 0 },
+      { wxCMD_LINE_SWITCH, "v", "verbose", "shows the search progress", wxCMD_LINE_VAL_NONE, 0 },
+      { wxCMD_LINE_OPTION, "S", "stats", "writes timing and throughput counters to a file, in JSON (- for the standard error)", wxCMD_LINE_VAL_STRING, 0 },
+      { wxCMD_LINE_PARAM, NULL, NULL, "files or directories", wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_MULTIPLE },
+      wxCMD_LINE_DESC_END
+   };
+
+   wxCmdLineParser parser(cmdLineDesc, argc, argv);
+   parser.SetLogo(wxT("Monkey-Moore - A simple and powerful relative search tool\n"));
+
+   if (parser.Parse() != 0)
+      return 1;
+
+   wxString keyword, values, wildcard, charset, statsFile;
+   long bits = 8, threads = 0, memory = 0, preview = 40;
+
+   const bool relative = parser.Found(wxT("k"), &keyword);
+   const bool valueScan = parser.Found(wxT("s"), &values);
+
+   parser.Found(wxT("w"), &wildcard);
+   parser.Found(wxT("c"), &charset);
+   parser.Found(wxT("b"), &bits);
+   parser.Found(wxT("t"), &threads);
+   parser.Found(wxT("m"), &memory);
+   parser.Found(wxT("p"), &preview);
+   parser.Found(wxT("S"), &statsFile);
+
+   if (relative == valueScan)
+   {
+      wxFprintf(stderr, wxT("Either a keyword (-k) or values (-s) must be given.\n"));
+      return 1;
+   }
+
+   if (bits != 8 && bits != 16 && bits != 32)
+   {
+      wxFprintf(stderr, wxT("The data width must be 8, 16 or 32 bits.\n"));
+      return 1;
+   }
+
+   const bool allWidths = parser.Found(wxT("A"));
+
+   if (allWidths && parser.Found(wxT("b")))
+   {
+      wxFprintf(stderr, wxT("A data width (-b) can't be given when searching all of them (-A).\n"));
+      return 1;
+   }
+
+   // the widest search looks for the narrower data as well
+   if (allWidths)
+      bits = 32;
+
+   if (wildcard.length() > 1)
+   {
+      wxFprintf(stderr, wxT("The wildcard must be a single character.\n"));
+      return 1;
+   }
+
+   if (threads < 0 || memory < 0 || memory > 4095 || preview < 1)
+   {
+      wxFprintf(stderr, wxT("Invalid number of threads, memory size or preview width.\n"));
+      return 1;
+   }
+
+   // directories are searched recursively, and more than one file makes a batch
+   vector<wxString> files;
+
+   for (size_t i = 0; i < parser.GetParamCount(); ++i)
+   {
+      const wxString name = parser.GetParam(i);
+
+      if (wxDir::Exists(name))
+      {
+         wxArrayString found;
+         wxDir::GetAllFiles(name, &found);
+         found.Sort();
+
+         files.insert(files.end(), found.begin(), found.end());
+      }
+      else if (wxFile::Exists(name))
+         files.push_back(name);
+      else
+         wxFprintf(stderr, wxT("Couldn't find %s, skipping it.\n"), name);
+   }
+
+   shared_ptr<wxFile> file;
+
+   if (files.size() == 1 && !wxDir::Exists(parser.GetParam(0)))
+   {
+      file.reset(new wxFile());
+
+      if (!file->Open(files[0], wxFile::read))
+      {
+         wxFprintf(stderr, wxT("Couldn't open %s.\n"), files[0]);
+         return 1;
+      }
+
+      files.clear();
+   }
+   else if (files.empty())
+   {
+      wxFprintf(stderr, wxT("No files to search.\n"));
+      return 1;
+   }
+
+   vector<short> vals;
+
+   if (valueScan)
+   {
+      wxStringTokenizer tkz(values, wxT(" ,"));
+
+      while (tkz.HasMoreTokens())
+      {
+         long value;
+
+         if (!tkz.GetNextToken().ToLong(&value, 10))
+         {
+            wxFprintf(stderr, wxT("Invalid value in the value list.\n"));
+            return 1;
+         }
+
+         vals.push_back(static_cast<short>(value));
+      }
+   }
+
+   SearchParameters p = relative ?
+      SearchParameters(file, keyword, charset, wildcard.empty() ? 0 : wildcard[0]) :
+      SearchParameters(file, vals);
+
+   p.setEndianness(
+      parser.Found(wxT("E")) ? SearchParameters::both_endian :
+      parser.Found(wxT("B")) ? SearchParameters::big_endian : SearchParameters::little_endian);
+
+   p.setAllWidths(allWidths);
+
+   // the search needs some actual relative differences to look for
+   if (relative)
+   {
+      for (auto i = p.keywords.begin(); i != p.keywords.end(); ++i)
+      {
+         if (i->length() - count(i->begin(), i->end(), p.wildcard) < 3)
+         {
+            wxFprintf(stderr, wxT("Keywords need 3 or more characters, not counting wildcards.\n"));
+            return 1;
+         }
+      }
+
+      if (p.keywords.empty())
+      {
+         wxFprintf(stderr, wxT("No keyword given.\n"));
+         return 1;
+      }
+   }
+   else if (vals.size() < 2)
+   {
+      wxFprintf(stderr, wxT("Value scans need 2 or more values.\n"));
+      return 1;
+   }
+
+   SearchSettings settings;
+   settings.memoryPool = static_cast<uint32_t>(memory) * 1024 * 1024;
+   settings.numWorkers = static_cast<unsigned int>(threads);
+   settings.previewWidth = static_cast<int>(preview);
+   settings.decompress = !parser.Found(wxT("R"));
+
+   std::signal(SIGINT, OnInterrupt);
+
+   const bool verbose = parser.Found(wxT("v"));
+   const bool hexOffsets = !parser.Found(wxT("d"));
+
+   switch (bits)
+   {
+      case 16: return RunSearch<uint16_t>(p, files, settings, verbose, hexOffsets, statsFile);
+      case 32: return RunSearch<uint32_t>(p, files, settings, verbose, hexOffsets, statsFile);
+      default: return RunSearch<uint8_t>(p, files, settings, verbose, hexOffsets, statsFile);
+   }
+}
@@ -0,0 +1,1218 @@
+/*
+ * Monkey-Moore - A simple and powerful relative search tool
+ * Copyright (C) 2007 Ricardo J. Ricken (Darkl0rd)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef MONKEY_ENGINE_HPP
+#define MONKEY_ENGINE_HPP
+
+#include <wx/wxprec.h>
+
+#ifdef __BORLANDC__
+   #pragma hdrstop
+#endif
+
+#ifndef WX_PRECOMP
+   #include <wx/wx.h>
+#endif
+
+#include <wx/file.h>
+#include <wx/filename.h>
+#include <wx/platinfo.h>
+#include <wx/tokenzr.h>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <map>
+#include <cstring>
+#include <thread>
+#include <tuple>
+
+#include "byteswap.hpp"
+#include "monkey_moore.hpp"
+#include "monkey_multi.hpp"
+#include "monkey_mapping.hpp"
+#include "monkey_pool.hpp"
+#include "monkey_buffers.hpp"
+#include "monkey_stats.hpp"
+#include "monkey_stream.hpp"
+
+using namespace std;
+
+/**
+* Converts a string into the characters the search core works with.
+* @param str string
+* @return The same characters, one per element.
+*/
+inline u32string ToU32String (const wxString &str)
+{
+   u32string result;
+   result.reserve(str.length());
+
+   for (auto i = str.begin(); i != str.end(); ++i)
+      result += static_cast<char32_t>(static_cast<wxChar>(*i));
+
+   return result;
+}
+
+/**
+* Structure to keep track of the parameters used in the search.
+* It works for both types of searches - relative and value.
+*/
+struct SearchParameters
+{
+   /**
+   * Constructor, relative search version.
+   * @param[in] file Pointer to a previously allocated wxFile object.
+   * @param[in] keyw,pattern,wcard Parameters needed to perform the search.
+   * Several keywords may be given at once, separated by commas.
+   */
+   SearchParameters (shared_ptr<wxFile> &file, const wxString &keyw, const wxString &pattern, const wxChar wcard) :
+      search_type(relative), endianness(little_endian), all_widths(false),
+      m_file(move(file)), keyword(keyw), pattern(pattern), wildcard(wcard)
+   {
+      wxStringTokenizer tkz(keyw, wxT(","));
+
+      while (tkz.HasMoreTokens())
+      {
+         wxString kw = tkz.GetNextToken().Trim(true).Trim(false);
+
+         if (!kw.empty())
+            keywords.push_back(kw);
+      }
+   }
+
+   /**
+   * Constructor, value scan version.
+   * @param[in] file Pointer to a previously allocated wxFile object.
+   * @param[in] vals Vector of values needed for a value scan search.
+   */
+   SearchParameters (shared_ptr<wxFile> &file, vector <short> vals) :
+      search_type(value_scan), endianness(little_endian), all_widths(false), m_file(move(file)), values(vals) { }
+
+   /**
+   * Returns the number of characters in the longest keyword.
+   * Character in this context may be letters or numeric values.
+   * @return Keyword length.
+   */
+   uint32_t keylen () const
+   {
+      if (search_type != relative)
+         return static_cast<uint32_t>(values.size());
+
+      size_t len = 0;
+
+      for (auto i = keywords.begin(); i != keywords.end(); ++i)
+         len = max(len, i->length());
+
+      return static_cast<uint32_t>(len);
+   }
+
+   /**
+   * Sets the endianness to be used in multi-byte searches
+   * @param byteorder The desired endianness, possible values are: little_endian, big_endian
+   * or both_endian (when it's unknown: both are searched at once, and each result tells which one it is)
+   */
+   void setEndianness (int byteorder) {
+      endianness = static_cast<decltype(endianness)>(byteorder);
+   }
+
+   /**
+   * Searches the narrower data widths too, along with the one of the search, in the
+   * same read of the file (ie: a 32-bit search also looks for 8 and 16-bit data).
+   * @param all true to search every width at once
+   */
+   void setAllWidths (bool all) {
+      all_widths = all;
+   }
+
+   enum { relative, value_scan } search_type;
+   enum { little_endian, big_endian, both_endian } endianness;
+   bool all_widths;    /**< Narrower widths are searched too, each result telling its own */
+
+   shared_ptr<wxFile> m_file;
+
+   wxString keyword;   /**< Keyword, only valid for relative searches */
+   vector <wxString> keywords;  /**< Comma separated keywords, split */
+   wxString pattern;   /**< Custom character sequence, valid for relative searches */
+   wxChar wildcard;    /**< Character used as wildcard on relative searches */
+
+   vector <short> values;  /**< Values used on value scan searches */
+};
+
+/**
+* Resources the search may use, and how the results are shown.
+*/
+struct SearchSettings
+{
+   SearchSettings () : memoryPool(0), numWorkers(0), previewWidth(40), decompress(true) { }
+
+   uint32_t memoryPool;       /**< Bytes the search buffers may take (0 means the default) */
+   unsigned int numWorkers;   /**< Search threads (0 means one per hardware thread) */
+   int previewWidth;          /**< Characters shown in each result preview */
+   bool decompress;           /**< Compressed files are searched decompressed, not as they are */
+};
+
+/**
+* Receives the notifications of a search, and tells it when to stop.
+* All methods are called from the thread running the search (or its workers).
+*/
+class SearchObserver
+{
+public:
+   virtual ~SearchObserver () { }
+
+   /**
+   * Called as the search goes.
+   * @param msg what's being done
+   * @param progress percentage done
+   */
+   virtual void OnSearchUpdate (const wxString &msg, int progress) = 0;
+
+   /**
+   * Called when every block was searched and the results are ready.
+   */
+   virtual void OnSearchCompleted () = 0;
+
+   /**
+   * Called when the search stops after IsSearchAborted() returned true.
+   */
+   virtual void OnSearchAborted () = 0;
+
+   /**
+   * Called on batch searches when a file is done, with its results sorted and previewed.
+   * Workers call it as they finish, so it may run on several threads at once.
+   * @param index file index
+   */
+   virtual void OnFileCompleted (size_t /*index*/) { }
+
+   /**
+   * Called with each progress update, with the timing and throughput counters so far.
+   * @param summary counters of the search
+   */
+   virtual void OnSearchStats (const SearchStats::Summary &/*summary*/) { }
+
+   /**
+   * Polled every block, to find out whether the search must stop.
+   * @return True to abort the search.
+   */
+   virtual bool IsSearchAborted () = 0;
+};
+
+/**
+* Runs a search over a file, splitting it in blocks searched by a pool of workers.
+* It doesn't depend on the GUI: progress and cancellation go through a SearchObserver.
+*
+* Batch searches go over a list of files with the same pool, instead of one search
+* per file: small files are packed together in a single block, big ones are split
+* like a regular search, and each file gets its own results, reported as soon as
+* its last block is searched.
+* @tparam _Type Basic underlying type used to represent the data.
+*/
+template <typename _Type>
+class SearchEngine
+{
+public:
+   /**
+   * offset, equivalency, preview, keyword index, byte order (SearchParameters::little_endian or big_endian)
+   * and data width in bytes (the one of _Type, unless narrower widths were searched too)
+   */
+   typedef tuple<wxFileOffset, typename MonkeyMoore<_Type>::equivalency_type, wxString, int, int, int> result_type;
+   typedef function<void (vector<result_type> &)> sink_type;
+
+   /**
+   * Constructor, single file version (the one opened in the search parameters).
+   */
+   SearchEngine (SearchParameters p, vector<result_type> &results, const SearchSettings &settings, SearchObserver &observer) :
+   m_info(p), m_settings(settings), m_observer(observer), m_results(&results), m_batchResults(0)
+   {
+      m_multiByteSearch = sizeof(_Type) > 1;
+   }
+
+   /**
+   * Constructor, batch version. The file in the search parameters isn't used.
+   * @param files files to be searched
+   * @param results filled with the results of each file, in the same order
+   */
+   SearchEngine (SearchParameters p, const vector<wxString> &files, vector<vector<result_type>> &results, const SearchSettings &settings, SearchObserver &observer) :
+   m_info(p), m_settings(settings), m_observer(observer), m_files(files), m_results(0), m_batchResults(&results)
+   {
+      m_multiByteSearch = sizeof(_Type) > 1;
+      results.assign(files.size(), vector<result_type>());
+   }
+
+   /**
+   * Streams the results of a single file search as they're found, instead of storing
+   * them in the results vector. They come in file offset order, previews included,
+   * and the sink is never called by two threads at once.
+   * @param sink receives each group of results
+   */
+   void SetResultSink (sink_type sink) { m_sink = sink; }
+
+   /**
+   * Gets the timing and throughput counters of the last search, block by block.
+   * @return Search counters.
+   */
+   const SearchStats &GetStats () const { return m_stats; }
+
+   /**
+   * Runs the search, filling the results vector.
+   */
+   void Run ()
+   {
+      m_observer.OnSearchUpdate(_("Initializing..."), 0);
+
+      // there's nothing to search for without a keyword (or values), and the
+      // blocks overlap by the length of the longest one
+      assert(m_info.keylen() > 0);
+
+      if (!m_info.keylen())
+      {
+         m_observer.OnSearchCompleted();
+         return;
+      }
+
+      // creates a monkey-moore instance based on which type of search will be performed.
+      // all keywords are searched at once, in a single pass over the file.
+      vector<u32string> keywords;
+
+      for (auto i = m_info.keywords.begin(); i != m_info.keywords.end(); ++i)
+         keywords.push_back(ToU32String(*i));
+
+      unique_ptr<MonkeyMooreMulti<_Type>> moore(CreateSearcher<_Type>(keywords));
+
+      // narrower widths are searched on the same blocks, right after this one
+      unique_ptr<MonkeyMooreMulti<u8>> moore8;
+      unique_ptr<MonkeyMooreMulti<uint16_t>> moore16;
+
+      if (m_info.all_widths && sizeof(_Type) > 1)
+         moore8.reset(CreateSearcher<u8>(keywords));
+
+      if (m_info.all_widths && sizeof(_Type) > 2)
+         moore16.reset(CreateSearcher<uint16_t>(keywords));
+
+      const bool batch = m_batchResults != 0;
+
+      // sizes of the files being searched (unreadable ones count as empty)
+      vector<wxFileOffset> fileSizes;
+      wxFileOffset totalSize = 0;
+
+      // regular files are searched directly on the mapped pages; anything
+      // that can't be mapped falls back to reading each block into memory.
+      shared_ptr<FileMapping> mapping;
+
+      // compressed files are decompressed by this thread as the workers search them
+      unique_ptr<CompressedInput> stream;
+
+      if (batch)
+      {
+         for (auto i = m_files.begin(); i != m_files.end(); ++i)
+         {
+            const wxULongLong size = wxFileName::GetSize(*i);
+            fileSizes.push_back(size == wxInvalidSize ? 0 : static_cast<wxFileOffset>(size.GetValue()));
+         }
+      }
+      else
+      {
+         fileSizes.push_back(m_info.m_file->Length());
+
+         const CompressedInput::Format format = m_settings.decompress ?
+            CompressedInput::Detect(*m_info.m_file) : CompressedInput::none;
+
+         if (CompressedInput::IsSupported(format))
+            stream.reset(new CompressedInput(*m_info.m_file, format));
+         else
+         {
+            if (format != CompressedInput::none)
+               wxLogWarning(_("This file is compressed (%s), but this version can't decompress it: it'll be searched as it is."),
+                  CompressedInput::GetFormatName(format));
+
+            mapping.reset(new FileMapping(*m_info.m_file));
+
+            if (!mapping->IsOk())
+               mapping.reset();
+         }
+      }
+
+      for (auto i = fileSizes.begin(); i != fileSizes.end(); ++i)
+         totalSize += *i;
+
+      // the endianness is the same for every block, so we only check it once. values are
+      // loaded in the byte order asked for, or in both of them when it isn't known.
+      const int byteOrders = m_info.endianness == SearchParameters::both_endian ? both_orders :
+         NeedsSwap(m_info.endianness == SearchParameters::little_endian) ? swapped_order : native_order;
+
+      const auto dataTypeSize = sizeof(_Type);
+      const uint32_t kwOverlapSize = (m_info.keylen() - 1) * dataTypeSize;
+
+      // workers, blocks in flight and block size are derived from the user preferences
+      const uint32_t memoryPool = GetMemoryPoolSize();
+      unsigned int numWorkers = GetNumWorkers();
+
+      // every block in flight (being searched or waiting in the queue) costs one
+      // buffer when it's read from the disk (bytes are swapped as they're searched).
+      // batches may map some of their files, but most of them are read.
+      const uint32_t buffersPerBlock = mapping ? 0 : 1;
+
+      // too many workers for such a small pool: trade some of them for bigger blocks
+      if (buffersPerBlock && memoryPool / (2 * numWorkers * buffersPerBlock) < minBlockBaseSize)
+         numWorkers = max<uint32_t>(memoryPool / (2 * minBlockBaseSize * buffersPerBlock), 1);
+
+      const uint32_t blocksInFlight = 2 * numWorkers;
+      const uint32_t blockBudget = memoryPool / (blocksInFlight * max<uint32_t>(buffersPerBlock, 1));
+
+      // blocks are page multiples, keeping the overlapping bytes within the budget
+      const uint32_t blockBaseSize = max<uint32_t>(minBlockBaseSize,
+         (blockBudget - min<uint32_t>(blockBudget, kwOverlapSize + dataTypeSize - 1)) & ~(pageSize - 1));
+
+      const uint32_t blockSize = blockBaseSize + kwOverlapSize + dataTypeSize - 1;
+
+      // blocks still to be searched on each file. files smaller than a block are
+      // packed with others, so they're searched as a whole, in a single piece.
+      vector<uint32_t> remainingBlocks;
+
+      for (auto i = fileSizes.begin(); i != fileSizes.end(); ++i)
+         remainingBlocks.push_back(static_cast<uint32_t>(ceil(double(*i) / blockBaseSize)));
+
+      m_stats.Start(numWorkers);
+      m_stats.SetSetting("files", fileSizes.size());
+      m_stats.SetSetting("total_size", totalSize);
+      m_stats.SetSetting("memory_mapped", mapping ? 1 : 0);
+      m_stats.SetSetting("compressed", stream ? 1 : 0);
+      m_stats.SetSetting("memory_pool", memoryPool);
+      m_stats.SetSetting("workers", numWorkers);
+      m_stats.SetSetting("blocks_in_flight", blocksInFlight);
+      m_stats.SetSetting("keyword_overlap", kwOverlapSize);
+      m_stats.SetSetting("data_type_size", dataTypeSize);
+      m_stats.SetSetting("byte_orders", m_multiByteSearch && byteOrders == both_orders ? 2 : 1);
+      m_stats.SetSetting("data_widths", 1 + (moore8 ? 1 : 0) + (moore16 ? 1 : 0));
+      m_stats.SetSetting("block_size", blockSize);
+
+      // when each worker finished its last job, to time how long it waited for the next one
+      vector<SearchStats::clock_type::time_point> idleSince(numWorkers, SearchStats::clock_type::now());
+
+      // streamed blocks keep the bytes their previews may need on both sides
+      const uint32_t margin = stream ? min<uint32_t>(m_settings.previewWidth * dataTypeSize, blockBaseSize) : 0;
+
+      // blocks that aren't mapped are read into recycled buffers, allocated once: the
+      // reader waits for one to be released by the workers instead of allocating more.
+      BufferPool blockBuffers(mapping ? 0 : blocksInFlight, blockSize + 2 * margin);
+
+      // keeps track of progress, over the bytes of all files
+      wxFileOffset searchedSize = 0;
+
+      // data access synchronization objects
+      mutex resultsMutex;
+      mutex progressMutex;
+
+      // _______________________________________________________________________________________
+      // blocks of a single file may finish in any order, so their results wait here until
+      // every block before them is done, and are then handed over in file offset order.
+      map<uint32_t, vector<result_type>> reorderBuffer;
+      uint32_t nextDelivery = 0;
+
+      mutex deliveryMutex;
+      condition_variable blockDelivered;
+
+      auto deliver = [&, this] (uint32_t block, vector<result_type> &found)
+      {
+         lock_guard<mutex> lock(deliveryMutex);
+         reorderBuffer[block].swap(found);
+
+         for (auto i = reorderBuffer.begin(); i != reorderBuffer.end() && i->first == nextDelivery; ++nextDelivery)
+         {
+            if (!m_sink)
+               m_results->insert(m_results->end(), i->second.begin(), i->second.end());
+            else if (!i->second.empty())
+               m_sink(i->second);
+
+            i = reorderBuffer.erase(i);
+         }
+
+         blockDelivered.notify_all();
+      };
+
+      // this lambda is responsible for running the appropriate search algorithm,
+      // adjusting the offset of each result and appending them to the results pool.
+      // a job holds one block of a file, or several small files packed together.
+      auto search = [&, this] (const vector<piece_type> &pieces)
+      {
+         vector<result_type> found;
+
+         // results of a block mostly share a few equivalencies
+         preview_cache translations;
+
+         const size_t worker = WorkerPool::GetCurrentWorker();
+         SearchStats::clock_type::time_point mark = SearchStats::clock_type::now();
+         double queueWait = worker < idleSince.size() ? SearchStats::Seconds(idleSince[worker], mark) : 0;
+
+         // blocks still in the queue when the search is aborted are simply skipped
+         if (m_observer.IsSearchAborted())
+         {
+            // the ones after them may be waiting for their turn
+            if (!batch)
+               deliver(pieces.front().block, found);
+
+            if (worker < idleSince.size())
+               idleSince[worker] = SearchStats::clock_type::now();
+
+            return;
+         }
+
+         for (auto piece = pieces.begin(); piece != pieces.end(); ++piece)
+         {
+            const u8 *data = piece->data.get();
+            const uint32_t size = piece->size;
+
+            // the wait is charged to the first piece of the job
+            SearchStats::Counters counters;
+            counters.blocks = 1;
+            counters.bytes = min(size, blockBaseSize);
+            counters.seconds[SearchStats::read] = piece->readSeconds;
+            counters.seconds[SearchStats::queueWait] = queueWait;
+            queueWait = 0;
+
+            found.clear();
+
+            // the block is read once, and searched for each width while it's still in the cache
+            SearchPiece(*moore, data, size, piece->offset, blockBaseSize, byteOrders, found, counters.candidates);
+
+            if (moore8)
+               SearchPiece(*moore8, data, size, piece->offset, blockBaseSize, byteOrders, found, counters.candidates);
+
+            if (moore16)
+               SearchPiece(*moore16, data, size, piece->offset, blockBaseSize, byteOrders, found, counters.candidates);
+
+            counters.seconds[SearchStats::search] += SearchStats::Lap(mark);
+
+            // previews come from the block while it's still in memory
+            const FileMapping *pieceMapping = piece->source ? piece->source->mapping.get() : (batch ? 0 : mapping.get());
+            wxFile *pieceFile = piece->source ? &piece->source->file : (batch || stream ? 0 : m_info.m_file.get());
+
+            sort(found.begin(), found.end(), ResultOrder);
+            counters.seconds[SearchStats::sort] += SearchStats::Lap(mark);
+
+            GeneratePreviews(found.begin(), found.end(), *piece, pieceFile, pieceMapping, translations);
+            counters.seconds[SearchStats::preview] += SearchStats::Lap(mark);
+
+            counters.results = found.size();
+
+            if (!batch)
+               deliver(piece->block, found);
+            else
+            {
+               bool fileDone;
+
+               {
+                  // prevent other threads from modifying the results while we're using it
+                  lock_guard<mutex> lock(resultsMutex);
+
+                  vector<result_type> &results = (*m_batchResults)[piece->file];
+                  results.insert(results.end(), found.begin(), found.end());
+
+                  fileDone = !--remainingBlocks[piece->file];
+               }
+
+               // no other worker touches the results of a finished file
+               if (fileDone)
+                  CompleteFile(piece->file);
+            }
+
+            counters.seconds[SearchStats::merge] += SearchStats::Lap(mark);
+            m_stats.AddBlock(piece->file, piece->block, worker, counters);
+
+            {
+               lock_guard<mutex> lock(progressMutex);
+
+               // overlapping bytes are counted on the next block (streams count the compressed ones)
+               searchedSize += stream ? piece->inputSize : min(size, blockBaseSize);
+
+               m_observer.OnSearchStats(m_stats.GetSummary());
+               m_observer.OnSearchUpdate(_("Searching..."), static_cast<int>(ceil(100.0 * searchedSize / totalSize)));
+            }
+         }
+
+         if (worker < idleSince.size())
+            idleSince[worker] = SearchStats::clock_type::now();
+      };
+      // _______________________________________________________________________________________
+
+      // besides the blocks being searched, the queue holds just enough blocks
+      // to keep the workers busy while the next one is being read from the disk.
+      WorkerPool workers(numWorkers, blocksInFlight - numWorkers);
+
+      // small files waiting to be packed in a block
+      vector<piece_type> pack;
+      shared_ptr<u8> packBuffer;
+      uint32_t packSize = 0;
+
+      // times the reads, and the waits for room in the queue (or in the reorder window)
+      SearchStats::clock_type::time_point mark;
+
+      auto submit = [&] (const vector<piece_type> &job)
+      {
+         mark = SearchStats::clock_type::now();
+         workers.Submit(bind(search, job));
+         m_stats.AddReaderTime(SearchStats::submitWait, SearchStats::Lap(mark));
+      };
+
+      // the queue may have room while every buffer is still taken, so this waits too
+      auto acquire = [&] () -> shared_ptr<u8>
+      {
+         mark = SearchStats::clock_type::now();
+         shared_ptr<u8> buffer = blockBuffers.Acquire();
+         m_stats.AddReaderTime(SearchStats::submitWait, SearchStats::Lap(mark));
+
+         return buffer;
+      };
+
+      // reads the files sequentially and hands their blocks over to the workers
+      for (size_t file = 0; file < fileSizes.size(); ++file)
+      {
+         // checks if the search was aborted in the main thread
+         if (m_observer.IsSearchAborted())
+         {
+            workers.Cancel();
+            workers.Wait();
+
+            m_stats.Stop();
+            m_observer.OnSearchAborted();
+            return;
+         }
+
+         const wxFileOffset fileSize = fileSizes[file];
+
+         // each batch file has a handle of its own, kept open while its blocks are read
+         shared_ptr<MappedFile> source;
+
+         if (batch && fileSize)
+         {
+            source.reset(new MappedFile(m_files[file], fileSize >= blockBaseSize));
+
+            if (!source->file.IsOpened())
+            {
+               {
+                  lock_guard<mutex> lock(resultsMutex);
+                  remainingBlocks[file] = 0;
+               }
+
+               lock_guard<mutex> lock(progressMutex);
+               searchedSize += fileSize;
+            }
+         }
+
+         if (batch && !remainingBlocks[file])
+         {
+            CompleteFile(file);
+            continue;
+         }
+
+         // small batch files are read whole, and queued once there's enough of them
+         if (batch && fileSize < blockBaseSize)
+         {
+            if (packSize + fileSize > blockBaseSize)
+            {
+               submit(pack);
+
+               pack.clear();
+               packBuffer.reset();
+               packSize = 0;
+            }
+
+            // the files of a pack share a single buffer
+            if (!packBuffer)
+               packBuffer = acquire();
+
+            mark = SearchStats::clock_type::now();
+            const ssize_t read = source->file.Read(packBuffer.get() + packSize, fileSize);
+
+            const double readSeconds = SearchStats::Lap(mark);
+            m_stats.AddReaderTime(SearchStats::read, readSeconds);
+
+            // a file that can't be read in full (ie: truncated meanwhile) is skipped,
+            // just like one that can't be opened; its slot in the buffer is reused
+            if (read != fileSize)
+            {
+               wxLogWarning(_("Failed to read \"%s\": it wasn't searched."), m_files[file]);
+
+               {
+                  lock_guard<mutex> lock(resultsMutex);
+                  remainingBlocks[file] = 0;
+               }
+
+               {
+                  lock_guard<mutex> lock(progressMutex);
+                  searchedSize += fileSize;
+               }
+
+               CompleteFile(file);
+               continue;
+            }
+
+            // the whole file is in memory, so its handle isn't kept
+            pack.push_back(piece_type(file, 0, shared_ptr<const u8>(packBuffer, packBuffer.get() + packSize), 0, static_cast<uint32_t>(fileSize), 0));
+            pack.back().readSeconds = readSeconds;
+            packSize += static_cast<uint32_t>(fileSize);
+            continue;
+         }
+
+         // the stream can't be read again, so each block keeps the bytes around it
+         // that previews may need (whatever lies past the ends is left zeroed)
+         if (stream)
+         {
+            // tail of the previous block: its overlap, and the margins on both sides
+            vector<u8> carry;
+
+            for (uint32_t i = 0; !m_observer.IsSearchAborted(); ++i)
+            {
+               const uint32_t lead = i ? margin : 0;
+               const uint32_t wanted = lead + blockSize + margin;
+               const wxFileOffset inputStart = stream->GetInputPosition();
+
+               shared_ptr<u8> buffer = acquire();
+               mark = SearchStats::clock_type::now();
+
+               if (!carry.empty())
+                  memcpy(buffer.get(), carry.data(), carry.size());
+
+               const uint32_t length = static_cast<uint32_t>(carry.size() + stream->Read(buffer.get() + carry.size(), wanted - carry.size()));
+
+               const double readSeconds = SearchStats::Lap(mark);
+               m_stats.AddReaderTime(SearchStats::read, readSeconds);
+
+               // the previous block went up to the end
+               if (length <= lead)
+                  break;
+
+               const uint32_t thisBlockSize = min(blockSize, length - lead);
+               const uint32_t next = lead + blockBaseSize - margin;
+
+               if (next < length)
+                  carry.assign(buffer.get() + next, buffer.get() + length);
+               else
+                  carry.clear();
+
+               if (!batch)
+               {
+                  mark = SearchStats::clock_type::now();
+
+                  unique_lock<mutex> lock(deliveryMutex);
+                  blockDelivered.wait(lock, [&] { return i < nextDelivery + reorderWindow * blocksInFlight; });
+
+                  m_stats.AddReaderTime(SearchStats::submitWait, SearchStats::Lap(mark));
+               }
+
+               vector<piece_type> job(1, piece_type(file, i, shared_ptr<const u8>(buffer, buffer.get() + lead),
+                  static_cast<wxFileOffset>(i) * blockBaseSize, thisBlockSize, 0));
+
+               job.front().readSeconds = readSeconds;
+               job.front().inputSize = static_cast<uint32_t>(stream->GetInputPosition() - inputStart);
+               job.front().lead = lead;
+               job.front().trail = length - lead - thisBlockSize;
+
+               submit(job);
+            }
+
+            if (!stream->IsOk())
+               wxLogWarning(_("The compressed data is corrupt or truncated: only what comes before the error was searched."));
+
+            continue;
+         }
+
+         wxFile &input = batch ? source->file : *m_info.m_file;
+         const u8 *mapped = batch ?
+            (source->mapping && source->mapping->IsOk() ? source->mapping->GetData() : 0) :
+            (mapping ? mapping->GetData() : 0);
+
+         // number of blocks
+         const uint32_t numBlocks = static_cast<uint32_t>(ceil(double(fileSize) / blockBaseSize));
+
+         for (uint32_t i = 0; i < numBlocks; ++i)
+         {
+            if (m_observer.IsSearchAborted())
+               break;
+
+            // each block has some extra overlapping bytes so we don't miss
+            // a possible match split between two different blocks.
+            const wxFileOffset blockOffset = static_cast<wxFileOffset>(i) * blockBaseSize;
+            const uint32_t thisBlockSize = static_cast<uint32_t>(min<wxFileOffset>(blockSize, fileSize - blockOffset));
+
+            shared_ptr<const u8> blockData;
+            double readSeconds = 0;
+
+            if (mapped)
+            {
+               // shares ownership of the mapping, pointing straight into the block
+               blockData = batch ?
+                  shared_ptr<const u8>(source, mapped + blockOffset) :
+                  shared_ptr<const u8>(mapping, mapped + blockOffset);
+            }
+            else
+            {
+               shared_ptr<u8> buffer = acquire();
+               mark = SearchStats::clock_type::now();
+
+               lock_guard<mutex> lock(m_fileMutex);
+
+               input.Seek(blockOffset, wxFromStart);
+               input.Read(buffer.get(), thisBlockSize);
+
+               blockData = buffer;
+
+               readSeconds = SearchStats::Lap(mark);
+               m_stats.AddReaderTime(SearchStats::read, readSeconds);
+            }
+
+            // finished blocks can't pile up behind a slow one: their results are
+            // kept until delivered, so they must not get too far ahead of it
+            if (!batch)
+            {
+               mark = SearchStats::clock_type::now();
+
+               unique_lock<mutex> lock(deliveryMutex);
+               blockDelivered.wait(lock, [&] { return i < nextDelivery + reorderWindow * blocksInFlight; });
+
+               m_stats.AddReaderTime(SearchStats::submitWait, SearchStats::Lap(mark));
+            }
+
+            vector<piece_type> job(1, piece_type(file, i, blockData, blockOffset, thisBlockSize, source));
+            job.front().readSeconds = readSeconds;
+
+            // blocks while the queue is full
+            submit(job);
+         }
+      }
+
+      if (!pack.empty())
+         submit(pack);
+
+      // we need to wait until all blocks have been searched
+      workers.Wait();
+      m_stats.Stop();
+
+      if (m_observer.IsSearchAborted())
+      {
+         m_observer.OnSearchAborted();
+         return;
+      }
+
+      m_observer.OnSearchCompleted();
+   }
+
+private:
+   /**
+   * File of a batch search, mapped when it's big enough to be worth it.
+   */
+   struct MappedFile
+   {
+      MappedFile (const wxString &name, bool map) : file(name)
+      {
+         if (map && file.IsOpened())
+            mapping.reset(new FileMapping(file));
+      }
+
+      wxFile file;
+      unique_ptr<FileMapping> mapping;  /**< null when not mapped */
+   };
+
+   /**
+   * Part of a job: a block of a file, or a whole small file.
+   */
+   struct piece_type
+   {
+      piece_type (size_t f, uint32_t b, shared_ptr<const u8> d, wxFileOffset o, uint32_t s, shared_ptr<MappedFile> src) :
+         file(f), block(b), data(d), offset(o), size(s), source(src), readSeconds(0), inputSize(0), lead(0), trail(0) { }
+
+      size_t file;                /**< file index                 */
+      uint32_t block;             /**< block index in the file    */
+      shared_ptr<const u8> data;  /**< piece data                 */
+      wxFileOffset offset;        /**< piece offset in the file   */
+      uint32_t size;              /**< piece size, in bytes       */
+
+      shared_ptr<MappedFile> source;  /**< batch file handle (null for whole files and single searches) */
+      double readSeconds;             /**< time spent reading it (0 when mapped)                        */
+
+      // compressed files only
+      uint32_t inputSize;  /**< compressed bytes it was decompressed from                  */
+      uint32_t lead;       /**< bytes kept before the piece data, for the previews          */
+      uint32_t trail;      /**< bytes kept after the piece data, for the previews           */
+   };
+
+   /** translation tables, by equivalency and data width */
+   typedef map<pair<typename MonkeyMoore<_Type>::equivalency_type, int>, map<_Type, wxChar>> preview_cache;
+
+   /**
+   * Creates the searcher of a data width, for the keywords (or values) of the search.
+   * @param keywords keywords of a relative search
+   * @return The searcher.
+   */
+   template <typename _Width>
+   MonkeyMooreMulti<_Width> *CreateSearcher (const vector<u32string> &keywords) const
+   {
+      return m_info.search_type == SearchParameters::relative ?
+         new MonkeyMooreMulti<_Width>(keywords, static_cast<char32_t>(m_info.wildcard), ToU32String(m_info.pattern)) :
+         new MonkeyMooreMulti<_Width>(m_info.values);
+   }
+
+   /**
+   * Searches a piece for the values of a data width, appending the results to the ones found so far.
+   * Multibyte values may start on any byte: every alignment (and byte order) is searched in the
+   * same pass, and the data is left untouched (bytes are swapped as values are loaded).
+   * @param moore searcher of the width
+   * @param data,size piece data
+   * @param offset piece offset in the file
+   * @param limit results starting past it are left to the next block, which has them too
+   * (only shorter keywords and narrower widths fit in the overlapping bytes)
+   * @param byteOrders byte orders searched (lane_order)
+   * @param found where results go
+   * @param candidates incremented by the number of candidate positions verified
+   */
+   template <typename _Width>
+   void SearchPiece (MonkeyMooreMulti<_Width> &moore, const u8 *data, uint32_t size, wxFileOffset offset, uint32_t limit,
+      int byteOrders, vector<result_type> &found, uint64_t &candidates)
+   {
+      vector<typename MonkeyMooreMulti<_Width>::relative_type> localResults[2];
+
+      if (sizeof(_Width) == 1)
+         localResults[0] = moore.search(reinterpret_cast<const _Width *>(data), size, &candidates);
+      else
+         moore.search_lanes(data, size, byteOrders, localResults, &candidates);
+
+      for (int order = 0; order < 2; ++order)
+      {
+         const int byteOrder = ByteOrder(order != 0);
+
+         for (auto elem = localResults[order].begin(); elem != localResults[order].end(); ++elem)
+         {
+            if (get<0>(*elem) < limit)
+               found.push_back(make_tuple(offset + get<0>(*elem), typename MonkeyMoore<_Type>::equivalency_type(get<2>(*elem)),
+                  wxString(), get<1>(*elem), byteOrder, static_cast<int>(sizeof(_Width))));
+         }
+      }
+   }
+
+   /**
+   * Sorts the results of a batch file once all of its blocks were searched.
+   * @param index file index
+   */
+   void CompleteFile (size_t index)
+   {
+      vector<result_type> &results = (*m_batchResults)[index];
+      sort(results.begin(), results.end(), ResultOrder);
+
+      m_observer.OnFileCompleted(index);
+   }
+
+   /**
+   * Orders results by offset, the same way whether they have previews or not.
+   */
+   static bool ResultOrder (const result_type &a, const result_type &b)
+   {
+      return tie(get<0>(a), get<5>(a), get<1>(a), get<3>(a), get<4>(a)) < tie(get<0>(b), get<5>(b), get<1>(b), get<3>(b), get<4>(b));
+   }
+
+   enum
+   {
+      reorderWindow = 4,           /**< blocks kept per block in flight, waiting for delivery */
+      pageSize = 4096,             /**< blocks are multiples of this   */
+      minBlockBaseSize = 65536,    /**< smallest block worth searching */
+      defaultMemoryPool = 8388608  /**< used when the setting is bogus */
+   };
+
+   /**
+   * Gets the amount of memory the search may use for its buffers.
+   * @return Memory pool size in bytes.
+   */
+   uint32_t GetMemoryPoolSize () const
+   {
+      return m_settings.memoryPool ? m_settings.memoryPool : static_cast<uint32_t>(defaultMemoryPool);
+   }
+
+   /**
+   * Gets the number of search threads.
+   * @return Number of workers.
+   */
+   unsigned int GetNumWorkers () const
+   {
+      return m_settings.numWorkers ? m_settings.numWorkers : max(thread::hardware_concurrency(), 1u);
+   }
+
+   /**
+   * Finds out whether bytes must be swapped, which happens only when the endianness
+   * of the system is different from the the endianness defined in the search options.
+   * @param littleEndian If the search is little endian or not
+   * @return True if multibyte values need their bytes swapped.
+   */
+   bool NeedsSwap (bool littleEndian) const
+   {
+      bool sysLittleEndian = m_sysinfo.GetEndianness() == wxEndianness::wxENDIAN_LITTLE;
+      return sysLittleEndian != littleEndian;
+   }
+
+   /**
+   * Finds out the byte order of the values the search loads.
+   * @param swapped whether their bytes were swapped
+   * @return SearchParameters::little_endian or SearchParameters::big_endian.
+   */
+   int ByteOrder (bool swapped) const
+   {
+      const bool sysLittleEndian = m_sysinfo.GetEndianness() == wxEndianness::wxENDIAN_LITTLE;
+      return sysLittleEndian != swapped ? SearchParameters::little_endian : SearchParameters::big_endian;
+   }
+
+   /**
+   * Check the endianness of the system against the desired endianness in the search
+   * and swap byte positions when _Value is a multibyte type.
+   * @param data Target block of data
+   * @param size Size of the block of data in bytes
+   * @param littleEndian If the search is little endian or not
+   */
+   template <typename _Value>
+   void HandleEndianness (_Value *dataPtr, uint32_t dataSize, bool littleEndian)
+   {
+      if (sizeof(_Value) > 1 && NeedsSwap(littleEndian))
+      {
+         transform(dataPtr, dataPtr + dataSize, dataPtr, [](_Value elem) -> _Value {
+            return swap_always<_Value>(elem);
+         });
+      }
+   }
+
+   /**
+   * Returns the length of the keyword a result refers to.
+   * @param index keyword index
+   * @return Keyword length.
+   */
+   size_t KeywordLength (int index) const
+   {
+      return m_info.search_type == SearchParameters::relative ?
+         m_info.keywords[index].size() : m_info.values.size();
+   }
+
+   /**
+   * Finds out where the preview of a result starts, so the keyword is in its center.
+   * @param offset result offset in the file
+   * @param kwLength length of the matched keyword
+   * @param dataWidth data width of the result, in bytes
+   * @return Preview offset in the file.
+   */
+   wxFileOffset PreviewOffset (const wxFileOffset offset, size_t kwLength, int dataWidth)
+   {
+      const int width = m_settings.previewWidth;
+
+      const uint32_t kwAlignWidth = floor(double(kwLength) / 2);
+
+      int64_t offsetDelta = dataWidth * roundUp((width / 2) - kwAlignWidth, dataWidth);
+
+      if (kwLength > static_cast<size_t>(width))
+         offsetDelta = 0;
+
+      // changes the offset so we can put the keyword in the center of the preview
+      wxFileOffset nice_pos = offset - offsetDelta;
+
+      // near the start of the file, the preview starts on the first value aligned
+      // like the result, so it's read with the same boundaries as the keyword
+      return nice_pos >= 0 ? nice_pos : offset % dataWidth;
+   }
+
+   /**
+   * Generates the previews of the results found on a block.
+   * Most of them lie inside the block, and are taken straight from its data. The ones
+   * crossing its edges are read from the mapping or, when the file isn't mapped, from
+   * the file, with a single read for each group of overlapping previews.
+   * @param first,last results found on the block
+   * @param piece the block
+   * @param file file to read from (null when the block holds the whole file, or comes from a stream)
+   * @param mapping file mapping (null when the file isn't mapped)
+   * @param cache translation tables, by equivalency
+   */
+   void GeneratePreviews (typename vector<result_type>::iterator first, typename vector<result_type>::iterator last,
+      const piece_type &piece, wxFile *file, const FileMapping *mapping, preview_cache &cache)
+   {
+      // bytes taken by the previews of the widest results
+      const size_t windowSize = m_settings.previewWidth * sizeof(_Type);
+
+      vector<pair<wxFileOffset, typename vector<result_type>::iterator>> outside;
+
+      for (auto i = first; i != last; ++i)
+      {
+         const wxFileOffset start = PreviewOffset(get<0>(*i), KeywordLength(get<3>(*i)), get<5>(*i));
+
+         if (start >= piece.offset - piece.lead && start + m_settings.previewWidth * get<5>(*i) <= piece.offset + piece.size + piece.trail)
+            get<2>(*i) = RenderPreview(piece.data.get() + (start - piece.offset), *i, cache);
+         else
+            outside.push_back(make_pair(start, i));
+      }
+
+      sort(outside.begin(), outside.end());
+
+      for (size_t run = 0, end; run < outside.size(); run = end)
+      {
+         const wxFileOffset runStart = outside[run].first;
+         wxFileOffset runEnd = runStart + windowSize;
+
+         for (end = run + 1; end < outside.size() && outside[end].first <= runEnd; ++end)
+            runEnd = outside[end].first + windowSize;
+
+         // whatever lies past the end of the file is left zeroed
+         vector<u8> buffer(static_cast<size_t>(runEnd - runStart));
+
+         if (mapping)
+         {
+            const wxFileOffset available = max<wxFileOffset>(mapping->GetLength() - runStart, 0);
+            memcpy(buffer.data(), mapping->GetData() + runStart, static_cast<size_t>(min<wxFileOffset>(available, buffer.size())));
+         }
+         else if (file)
+         {
+            // the handle is shared with the thread reading the blocks
+            lock_guard<mutex> lock(m_fileMutex);
+
+            file->Seek(runStart, wxFromStart);
+            file->Read(buffer.data(), buffer.size());
+         }
+
+         for (size_t i = run; i < end; ++i)
+            get<2>(*outside[i].second) = RenderPreview(buffer.data() + (outside[i].first - runStart), *outside[i].second, cache);
+      }
+   }
+
+   /**
+   * Translates the data of a preview into text, reading it with the width of its result.
+   * @param data preview data, as read from the file
+   * @param result the result
+   * @param cache translation tables, by equivalency and width
+   * @return Result preview.
+   */
+   wxString RenderPreview (const u8 *data, const result_type &result, preview_cache &cache)
+   {
+      switch (get<5>(result))
+      {
+         case 1: return RenderValues<u8>(data, get<1>(result), get<4>(result), cache);
+         case 2: return RenderValues<uint16_t>(data, get<1>(result), get<4>(result), cache);
+         default: return RenderValues<uint32_t>(data, get<1>(result), get<4>(result), cache);
+      }
+   }
+
+   /**
+   * Translates the values of a preview into text.
+   * @param data preview data, as read from the file
+   * @param table equivalency table
+   * @param byteOrder byte order of the result
+   * @param cache translation tables, by equivalency and width
+   * @return Result preview.
+   */
+   template <typename _Value>
+   wxString RenderValues (const u8 *data, const typename MonkeyMoore<_Type>::equivalency_type &table, int byteOrder, preview_cache &cache)
+   {
+      vector<_Value> raw(m_settings.previewWidth);
+      memcpy(raw.data(), data, raw.size() * sizeof(_Value));
+
+      // swap bytes when needed
+      HandleEndianness(raw.data(), static_cast<uint32_t>(raw.size()), byteOrder == SearchParameters::little_endian);
+
+      wxString result;
+
+      if (m_info.search_type == SearchParameters::relative)
+      {
+         const auto key = make_pair(table, static_cast<int>(sizeof(_Value)));
+         auto cached = cache.find(key);
+
+         // maps the table entries (values past the maximum wrap around within the width)
+         if (cached == cache.end())
+         {
+            map <_Type, wxChar> &cur_table = cache[key];
+
+            const auto values = table.expand();
+
+            // generates the table
+            for (auto i = values.begin(); i != values.end(); i++)
+            {
+               if (!m_info.pattern.length() && (i->first == wxT('A') || i->first == wxT('a')))
+                  for (int j = 0; j < 26; j++)
+                     cur_table[static_cast <_Value> (i->second + j)] = static_cast <wxChar> (i->first + j);
+               else
+                  cur_table[static_cast <_Value> (i->second)] = static_cast <wxChar> (i->first);
+            }
+
+            cached = cache.find(key);
+         }
+
+         const map <_Type, wxChar> &cur_table = cached->second;
+         result.reserve(raw.size());
+
+         // replace the available characters
+         for (auto start = raw.begin(); start != raw.end(); start++)
+         {
+            auto c = cur_table.find(*start);
+            result += c != cur_table.end() ? c->second : wxT('#');
+         }
+      }
+      else
+      {
+         static const wxChar digits[] = wxT("0123456789ABCDEF");
+         result.reserve(raw.size() * (sizeof(_Value) * 2 + 1));
+
+         // same as "%02X ", without formatting each value
+         for (auto start = raw.begin(); start != raw.end(); start++)
+         {
+            int shift = sizeof(_Value) * 8 - 4;
+
+            while (shift > 4 && !(*start >> shift))
+               shift -= 4;
+
+            for (; shift >= 0; shift -= 4)
+               result += digits[(*start >> shift) & 0xF];
+
+            result += wxT(' ');
+         }
+
+         // erase trailing whitespace
+         result.erase(result.length() - 1);
+      }
+
+      return result;
+   }
+
+   /**
+   * Rounds a number up to the next multiple that is a power of 2.
+   * @param num Number to be rounded.
+   * @param multiple a power of 2 multiple
+   * @return Rounded number
+   */
+   inline int64_t roundUp (int64_t num, int32_t multiple) {
+      return (num + multiple - 1) & ~(multiple - 1);
+   }
+
+   bool m_multiByteSearch;
+   SearchParameters m_info;
+   wxPlatformInfo m_sysinfo;
+   SearchSettings m_settings;
+   SearchObserver &m_observer;
+
+   vector <wxString> m_files;                     /**< batch files                     */
+   sink_type m_sink;                              /**< receives the streamed results   */
+   mutex m_fileMutex;                             /**< guards reads on the single file */
+   SearchStats m_stats;                           /**< counters of the last search     */
+   vector <result_type> *m_results;               /**< single file results             */
+   vector <vector <result_type>> *m_batchResults; /**< batch results (null otherwise) */
+};
+
+#endif //~MONKEY_ENGINE_HPP
@@ -0,0 +1,232 @@
+/*
+ * Monkey-Moore - A simple and powerful relative search tool
+ * Copyright (C) 2007 Ricardo J. Ricken (Darkl0rd)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef MONKEY_EQUIVALENCY_HPP
+#define MONKEY_EQUIVALENCY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <map>
+#include <vector>
+#include <functional>
+#include <unordered_set>
+
+/**
+* Equivalency table of a relative search match, ie: which value each character has.
+*
+* Every character of a match is shifted by the same amount, so the table is kept
+* as that shift alone: the values of 'A' and 'a' on ASCII searches (they only
+* differ when the key mixes upper and lower case), or the value of the first
+* character of the custom character set, which is shared by every match.
+* Building one costs no allocation; the full table is only generated by expand().
+*/
+template <class Ty> class equivalency_table
+{
+public:
+   typedef std::vector <char32_t> charset_type;
+   typedef std::map <char32_t, Ty> map_type;
+
+   /**
+   * Constructor. Creates an empty table, as used by value scans.
+   */
+   equivalency_table () : kind(empty), first(0), second(0) { }
+
+   /**
+   * Converts the table of another value width (ie: to list results of several widths together).
+   * Values are cast, so narrowing it back gives the original table.
+   * @param t equivalency table
+   */
+   template <class T> explicit equivalency_table (const equivalency_table<T> &t) :
+   kind(static_cast <decltype(kind)> (static_cast <int> (t.kind))),
+   first(static_cast <Ty> (t.first)), second(static_cast <Ty> (t.second)), chars(t.chars) { }
+
+   /**
+   * Creates the table of an ASCII match.
+   * @param upper value of 'A'
+   * @param lower value of 'a'
+   * @return The equivalency table.
+   */
+   static equivalency_table ascii (Ty upper, Ty lower)
+   {
+      equivalency_table t;
+      t.kind = ascii_letters;
+      t.first = upper;
+      t.second = lower;
+
+      return t;
+   }
+
+   /**
+   * Creates the table of a custom character set match.
+   * @param set character set used by the search
+   * @param base value of the first character of the set
+   * @return The equivalency table.
+   */
+   static equivalency_table charset (const std::shared_ptr <const charset_type> &set, Ty base)
+   {
+      equivalency_table t;
+      t.kind = custom_charset;
+      t.first = base;
+      t.chars = set;
+
+      return t;
+   }
+
+   /**
+   * Generates the full table.
+   * On ASCII searches, only 'A' and 'a' are listed, and the other letters follow them.
+   * @return Value of each character.
+   */
+   map_type expand () const
+   {
+      map_type eq;
+
+      if (kind == ascii_letters)
+      {
+         eq[U'A'] = first;
+         eq[U'a'] = second;
+      }
+      else if (kind == custom_charset)
+      {
+         // repeated characters take the value of their last position
+         for (size_t i = 0; i < chars->size(); i++)
+            eq[(*chars)[i]] = static_cast <Ty> (first + i);
+      }
+
+      return eq;
+   }
+
+   /**
+   * Finds out whether the table has no values (ie: on value scans).
+   * @return True if it's empty.
+   */
+   bool is_empty () const { return kind == empty; }
+
+   bool operator== (const equivalency_table &t) const
+   {
+      return kind == t.kind && first == t.first && second == t.second && same_charset(t);
+   }
+
+   bool operator!= (const equivalency_table &t) const { return !(*this == t); }
+
+   bool operator< (const equivalency_table &t) const
+   {
+      if (kind != t.kind) return kind < t.kind;
+      if (first != t.first) return first < t.first;
+      if (second != t.second) return second < t.second;
+
+      return !same_charset(t) && (!chars || (t.chars && *chars < *t.chars));
+   }
+
+   /**
+   * Hashes the table. The character set is left out: it's shared by every match.
+   * @return Hash value.
+   */
+   size_t hash () const
+   {
+      return (static_cast <size_t> (kind) * 31 + static_cast <size_t> (first)) * 0x9E3779B1u + static_cast <size_t> (second);
+   }
+
+private:
+   /**
+   * Compares the character sets, which usually are the very same object.
+   * @param t table to compare against
+   * @return True if both have the same characters.
+   */
+   bool same_charset (const equivalency_table &t) const
+   {
+      return chars == t.chars || (chars && t.chars && *chars == *t.chars);
+   }
+
+   enum { empty, ascii_letters, custom_charset } kind;
+
+   Ty first;   /**< value of 'A', or of the first character of the set */
+   Ty second;  /**< value of 'a' (ASCII only) */
+
+   std::shared_ptr <const charset_type> chars;  /**< custom character set */
+
+   template <class T> friend class equivalency_table;
+};
+
+namespace std
+{
+   template <class Ty> struct hash <equivalency_table<Ty>>
+   {
+      size_t operator() (const equivalency_table<Ty> &t) const { return t.hash(); }
+   };
+}
+
+/**
+* Keeps track of the distinct equivalency tables of a list of results, updated as
+* results are appended to it, so finding out which ones are repeated costs nothing.
+*/
+template <class Ty> class equivalency_index
+{
+public:
+   equivalency_index () : total(0) { }
+
+   /**
+   * Clears the index, along with the list of results.
+   */
+   void clear ()
+   {
+      seen.clear();
+      firsts.clear();
+      total = 0;
+   }
+
+   /**
+   * Adds the table of the next result of the list.
+   * @param t equivalency table
+   * @param group tables of different groups (ie: byte orders) never repeat each other
+   * @return True if no previous result of the group has the same table.
+   */
+   bool push_back (const equivalency_table<Ty> &t, size_t group = 0)
+   {
+      const uint32_t index = total++;
+
+      if (group >= seen.size())
+         seen.resize(group + 1);
+
+      if (!seen[group].insert(t).second)
+         return false;
+
+      firsts.push_back(index);
+      return true;
+   }
+
+   /**
+   * Returns the number of distinct tables.
+   * @return Number of results that aren't repeated.
+   */
+   size_t size () const { return firsts.size(); }
+
+   /**
+   * Returns where each distinct table first appears.
+   * @return Indexes of the results that aren't repeated, in order.
+   */
+   const std::vector <uint32_t> &first_results () const { return firsts; }
+
+private:
+   std::vector <std::unordered_set <equivalency_table<Ty>>> seen;  /**< distinct tables, by group */
+   std::vector <uint32_t> firsts;                    /**< first result with each one  */
+   uint32_t total;                                   /**< results in the list         */
+};
+
+#endif //~MONKEY_EQUIVALENCY_HPP
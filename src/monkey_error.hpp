@@ -43,11 +43,12 @@ enum
 class monkeymoore_error : public std::exception
 {
 public:
-   monkeymoore_error (const wxString &msg, int errorId) :
 #ifdef _WIN32
+   monkeymoore_error (const wxString &msg, int errorId) :
       std::exception(msg.c_str()), m_errorId(errorId) { }
 #else
-      std::exception() {}
+   monkeymoore_error (const wxString &, int errorId) :
+      std::exception(), m_errorId(errorId) { }
 #endif
 
    int code () const { return m_errorId; }
@@ -32,6 +32,7 @@
 #include <string>
 #include <memory>
 #include <array>
+#include <type_traits>
 
 using namespace std;
 
@@ -60,8 +61,11 @@ wxBEGIN_EVENT_TABLE(MonkeyFrame, wxFrame)
    EVT_RADIOBUTTON(MonkeyMoore_ValueScanSearch, MonkeyFrame::OnSearchType)
    EVT_RADIOBUTTON(MonkeyMoore_8bitMode, MonkeyFrame::OnSearchMode)
    EVT_RADIOBUTTON(MonkeyMoore_16bitMode, MonkeyFrame::OnSearchMode)
+   EVT_RADIOBUTTON(MonkeyMoore_32bitMode, MonkeyFrame::OnSearchMode)
+   EVT_RADIOBUTTON(MonkeyMoore_AutoWidthMode, MonkeyFrame::OnSearchMode)
    EVT_RADIOBUTTON(MonkeyMoore_ByteOrderBE, MonkeyFrame::OnByteOrder)
    EVT_RADIOBUTTON(MonkeyMoore_ByteOrderLE, MonkeyFrame::OnByteOrder)
+   EVT_RADIOBUTTON(MonkeyMoore_ByteOrderBoth, MonkeyFrame::OnByteOrder)
    EVT_SIZE(MonkeyFrame::OnSize)
    EVT_SHOW(MonkeyFrame::OnShow)
    EVT_TEXT_ENTER(MonkeyMoore_KWord, MonkeyFrame::OnTextEnter)
@@ -71,11 +75,12 @@ wxEND_EVENT_TABLE()
 wxDEFINE_EVENT(mmEVT_SEARCHTHREAD_COMPLETED, wxThreadEvent);
 wxDEFINE_EVENT(mmEVT_SEARCHTHREAD_UPDATE, wxThreadEvent);
 wxDEFINE_EVENT(mmEVT_SEARCHTHREAD_ABORTED, wxThreadEvent);
+wxDEFINE_EVENT(mmEVT_SEARCHTHREAD_RESULTS, wxThreadEvent);
 
 MonkeyFrame::MonkeyFrame (const wxString &title, MonkeyPrefs &mprefs, const wxPoint &pos, const wxSize &size) :
-wxFrame(0, wxID_ANY, title, pos, size, wxDEFAULT_FRAME_STYLE | wxTAB_TRAVERSAL), prefs(mprefs),
-search_done(false), search_in_progress(false), search_was_aborted(false), advanced_shown(false),
-searchmode_8bits(true), byteorder_little(true)
+wxFrame(0, wxID_ANY, title, pos, size, wxDEFAULT_FRAME_STYLE | wxTAB_TRAVERSAL),
+searchmode_bits(8), byteorder(SearchParameters::little_endian), advanced_shown(false),
+search_done(false), search_in_progress(false), search_was_aborted(false), prefs(mprefs)
 {
    SetIcon(wxICON(mmoore));
    wxValidator::SuppressBellOnError();
@@ -130,6 +135,8 @@ searchmode_8bits(true), byteorder_little(true)
    wxTextCtrl *wildcard = new wxTextCtrl(this, MonkeyMoore_Wildcard, wxEmptyString, wxDefaultPosition, wxSize(20, 21));
    wxRadioButton *searchmode_8bit = new wxRadioButton(this, MonkeyMoore_8bitMode, _(" 8-bit"), wxDefaultPosition, wxDefaultSize, wxRB_GROUP);
    wxRadioButton *searchmode_16bit = new wxRadioButton(this, MonkeyMoore_16bitMode, _(" 16-bit"));
+   wxRadioButton *searchmode_32bit = new wxRadioButton(this, MonkeyMoore_32bitMode, _(" 32-bit"));
+   wxRadioButton *searchmode_auto = new wxRadioButton(this, MonkeyMoore_AutoWidthMode, _(" Auto"));
 
    advanced->SetBitmap(images.GetBitmap(MonkeyBmp_ShowAdv));
    searchmode_8bit->SetValue(true);
@@ -142,6 +149,8 @@ searchmode_8bits(true), byteorder_little(true)
    searchopt_sz->AddStretchSpacer(1);
    searchopt_sz->Add(searchmode_8bit, wxSizerFlags().Right().Border(wxRIGHT, 4).Align(wxALIGN_CENTER_VERTICAL));
    searchopt_sz->Add(searchmode_16bit, wxSizerFlags().Right().Border(wxRIGHT, 4).Align(wxALIGN_CENTER_VERTICAL));
+   searchopt_sz->Add(searchmode_32bit, wxSizerFlags().Right().Border(wxRIGHT, 4).Align(wxALIGN_CENTER_VERTICAL));
+   searchopt_sz->Add(searchmode_auto, wxSizerFlags().Right().Border(wxRIGHT, 4).Align(wxALIGN_CENTER_VERTICAL));
    searchopt_sz->Add(advanced, wxSizerFlags().Right().Expand().Shaped().FixedMinSize());
 
    // -- search box
@@ -177,6 +186,7 @@ searchmode_8bits(true), byteorder_little(true)
    wxCheckBox *byteorder_enable = new wxCheckBox(this, MonkeyMoore_EnableByteOrder, _(" Byte order:"));
    wxRadioButton *byteorder_le = new wxRadioButton(this, MonkeyMoore_ByteOrderLE, _(" Little Endian"), wxDefaultPosition, wxDefaultSize, wxRB_GROUP);
    wxRadioButton *byteorder_be = new wxRadioButton(this, MonkeyMoore_ByteOrderBE, _(" Big Endian"));
+   wxRadioButton *byteorder_both = new wxRadioButton(this, MonkeyMoore_ByteOrderBoth, _(" Both"));
 
    byteorder_enable->SetValue(true);
 
@@ -184,6 +194,7 @@ searchmode_8bits(true), byteorder_little(true)
    advbyteorder_sz->Add(byteorder_enable, wxSizerFlags().Border(wxLEFT, 6));
    advbyteorder_sz->Add(byteorder_le, wxSizerFlags().Border(wxLEFT | wxRIGHT, 4));
    advbyteorder_sz->Add(byteorder_be, wxSizerFlags().Border(wxRIGHT, 4));
+   advbyteorder_sz->Add(byteorder_both, wxSizerFlags().Border(wxRIGHT, 4));
 
    // -- advanced box
    wxStaticBoxSizer *advancedbox_sz = new wxStaticBoxSizer(new wxStaticBox(this, wxID_ANY, _("Advanced")), wxVERTICAL);
@@ -218,7 +229,7 @@ searchmode_8bits(true), byteorder_little(true)
    resultopt_sz->AddSpacer(3);
 
    // result box
-   wxListCtrl *results = new wxListCtrl(this, MonkeyMoore_Results, wxDefaultPosition, wxDefaultSize, wxLC_REPORT | wxLC_SINGLE_SEL);
+   MonkeyResultList *results = new MonkeyResultList(this, MonkeyMoore_Results);
    wxCheckBox *show_all = new wxCheckBox(this, MonkeyMoore_AllResults, _(" Show repeated results"));
 
    results->InsertColumn(0, _("Offset"), wxLIST_FORMAT_LEFT, ResultListCol_Offset);
@@ -281,6 +292,12 @@ searchmode_8bits(true), byteorder_little(true)
    byteorder_enable->SetToolTip(_("Endianness format\n"
                                   "(used only with multi-byte searches)"));
 
+   byteorder_both->SetToolTip(_("Searches both endianness formats at once,\n"
+                                "telling which one each result is in"));
+
+   searchmode_auto->SetToolTip(_("Searches 8, 16 and 32-bit data at once,\n"
+                                 "telling which width each result is in"));
+
    adv_enablepat->SetToolTip(_("Specify a custom sequence of characters\n"
                                "which the relative search will be based upon"));
 
@@ -317,9 +334,19 @@ MonkeyFrame::~MonkeyFrame ()
 {
 }
 
+// results are handed over by the search threads as they are, so both tuples must stay the same
+static_assert(is_same<result_type8, SearchThread<uint8_t>::result_type>::value, "8-bit results differ from the search engine's");
+static_assert(is_same<result_type16, SearchThread<uint16_t>::result_type>::value, "16-bit results differ from the search engine's");
+static_assert(is_same<result_type32, SearchThread<uint32_t>::result_type>::value, "32-bit results differ from the search engine's");
+
 // template specializations to return a reference to the correct results vector
 template <> vector<result_type8> &MonkeyFrame::lastResults<uint8_t> () { return last_results8; }
 template <> vector<result_type16> &MonkeyFrame::lastResults<uint16_t> () { return last_results16; }
+template <> vector<result_type32> &MonkeyFrame::lastResults<uint32_t> () { return last_results32; }
+
+template <> equivalency_index<uint8_t> &MonkeyFrame::lastUnique<uint8_t> () { return last_unique8; }
+template <> equivalency_index<uint16_t> &MonkeyFrame::lastUnique<uint16_t> () { return last_unique16; }
+template <> equivalency_index<uint32_t> &MonkeyFrame::lastUnique<uint32_t> () { return last_unique32; }
 
 /**
 * Method called when the browse button is pressed.
@@ -366,19 +393,30 @@ void MonkeyFrame::OnSearchMode (wxCommandEvent &event)
 {
    wxPostEvent(this, wxCommandEvent(wxEVT_BUTTON, MonkeyMoore_Clear));
 
-   searchmode_8bits = event.GetId() == MonkeyMoore_8bitMode;
-
-   if (searchmode_8bits)
-   {
-      Bind(wxEVT_BUTTON, &MonkeyFrame::OnCreateTbl<uint8_t>, this, MonkeyMoore_CreateTbl);
-      Bind(wxEVT_BUTTON, &MonkeyFrame::OnClear<uint8_t>, this, MonkeyMoore_Clear);
-      Bind(wxEVT_CHECKBOX, &MonkeyFrame::OnAllResults<uint8_t>, this, MonkeyMoore_AllResults);
-   }
-   else
+   switch (event.GetId())
    {
-      Bind(wxEVT_BUTTON, &MonkeyFrame::OnCreateTbl<uint16_t>, this, MonkeyMoore_CreateTbl);
-      Bind(wxEVT_BUTTON, &MonkeyFrame::OnClear<uint16_t>, this, MonkeyMoore_Clear);
-      Bind(wxEVT_CHECKBOX, &MonkeyFrame::OnAllResults<uint16_t>, this, MonkeyMoore_AllResults);
+      case MonkeyMoore_8bitMode:
+         searchmode_bits = 8;
+         Bind(wxEVT_BUTTON, &MonkeyFrame::OnCreateTbl<uint8_t>, this, MonkeyMoore_CreateTbl);
+         Bind(wxEVT_BUTTON, &MonkeyFrame::OnClear<uint8_t>, this, MonkeyMoore_Clear);
+         Bind(wxEVT_CHECKBOX, &MonkeyFrame::OnAllResults<uint8_t>, this, MonkeyMoore_AllResults);
+         break;
+
+      case MonkeyMoore_16bitMode:
+         searchmode_bits = 16;
+         Bind(wxEVT_BUTTON, &MonkeyFrame::OnCreateTbl<uint16_t>, this, MonkeyMoore_CreateTbl);
+         Bind(wxEVT_BUTTON, &MonkeyFrame::OnClear<uint16_t>, this, MonkeyMoore_Clear);
+         Bind(wxEVT_CHECKBOX, &MonkeyFrame::OnAllResults<uint16_t>, this, MonkeyMoore_AllResults);
+         break;
+
+      case MonkeyMoore_32bitMode:
+      case MonkeyMoore_AutoWidthMode:
+         // every width is searched by the 32-bit search, so they share its results
+         searchmode_bits = event.GetId() == MonkeyMoore_32bitMode ? 32 : 0;
+         Bind(wxEVT_BUTTON, &MonkeyFrame::OnCreateTbl<uint32_t>, this, MonkeyMoore_CreateTbl);
+         Bind(wxEVT_BUTTON, &MonkeyFrame::OnClear<uint32_t>, this, MonkeyMoore_Clear);
+         Bind(wxEVT_CHECKBOX, &MonkeyFrame::OnAllResults<uint32_t>, this, MonkeyMoore_AllResults);
+         break;
    }
 }
 
@@ -386,7 +424,10 @@ void MonkeyFrame::OnByteOrder (wxCommandEvent &event)
 {
    wxPostEvent(this, wxCommandEvent(wxEVT_BUTTON, MonkeyMoore_Clear));
 
-   byteorder_little = event.GetId() == MonkeyMoore_ByteOrderLE;
+   byteorder =
+      event.GetId() == MonkeyMoore_ByteOrderLE ? SearchParameters::little_endian :
+      event.GetId() == MonkeyMoore_ByteOrderBE ? SearchParameters::big_endian :
+      SearchParameters::both_endian;
 }
 
 /**
@@ -434,8 +475,24 @@ void MonkeyFrame::OnSearch (wxCommandEvent &WXUNUSED(event))
          charpattern = cp->GetValue();
       }
 
-      // we need a valid keyword (when we use ascii)
-      if (!CheckKeyword(keyword, card, charpattern)) return;
+      // we need valid keywords (when we use ascii). several of them may be
+      // searched at once, separated by commas, and empty ones are left out.
+      wxStringTokenizer kwtkz(keyword, wxT(","));
+      int n_keywords = 0;
+
+      while (kwtkz.HasMoreTokens())
+      {
+         wxString kw = kwtkz.GetNextToken().Trim(true).Trim(false);
+
+         if (kw.empty())
+            continue;
+
+         if (!CheckKeyword(kw, card, charpattern)) return;
+         n_keywords++;
+      }
+
+      if (!n_keywords)
+         return ShowWarning(MM_WARNING_KWORDSIZE);
    }
    else
    {
@@ -470,15 +527,16 @@ void MonkeyFrame::OnSearch (wxCommandEvent &WXUNUSED(event))
       SearchParameters(file, keyword, charpattern, card) :
       SearchParameters(file, values);
 
-   if (searchmode_8bits)
+   if (searchmode_bits == 8)
       StartSearchThread<u8>(p);
    else
    {
-      p.setEndianness(byteorder_little ?
-         SearchParameters::little_endian :
-         SearchParameters::big_endian);
+      p.setEndianness(byteorder);
+      p.setAllWidths(searchmode_bits == 0);
 
-      StartSearchThread<u16>(p);
+      searchmode_bits == 16 ?
+         StartSearchThread<u16>(p) :
+         StartSearchThread<u32>(p);
    }
 }
 
@@ -555,9 +613,9 @@ void MonkeyFrame::OnCharsetChosen (wxCommandEvent &event)
 template <typename _DataType>
 void MonkeyFrame::OnAllResults (wxCommandEvent &event)
 {
-   // if there's a search in progress, the change will only take effect when it's done
-   if (!search_in_progress)
-      ShowResults<_DataType>(event.IsChecked());
+   // the list is virtual, so it's switched right away, even while searching
+   ShowResults<_DataType>(event.IsChecked());
+   AdjustResultColumns(true);
 }
 
 /**
@@ -567,26 +625,32 @@ void MonkeyFrame::OnAllResults (wxCommandEvent &event)
 template <typename _DataType>
 void MonkeyFrame::OnCreateTbl (wxCommandEvent &WXUNUSED(event))
 {
-   wxListCtrl *result_box = GetWindow<wxListCtrl>(MonkeyMoore_Results);
+   MonkeyResultList *result_box = GetWindow<MonkeyResultList>(MonkeyMoore_Results);
    int target = result_box->GetNextItem(-1, wxLIST_NEXT_ALL, wxLIST_STATE_SELECTED);
 
-   auto results = lastResults<_DataType>();
+   auto &results = lastResults<_DataType>();
 
    if (results.empty())
       return ShowWarning(MM_WARNING_TABLENORESULTS);
 
    if (target != wxNOT_FOUND)
    {
-      wxListItem sel_item;
-      sel_item.SetId(target);
-      sel_item.SetMask(wxLIST_MASK_DATA);
-
-      result_box->GetItem(sel_item);
-      wxASSERT(sel_item.GetData() < results.size());
+      const uint32_t index = result_box->GetResultIndex(target);
+      wxASSERT(index < results.size());
 
       MonkeyTable tbldiag(this, _("Create table file"), prefs, images, wxSize(400, 340));
 
-      tbldiag.InitTableData<_DataType>(get<1>(results.at(sel_item.GetData())), byteorder_little);
+      const auto &result = results.at(index);
+      const bool littleEndian = get<4>(result) == SearchParameters::little_endian;
+
+      // results of auto width searches get the table of the width they were found in
+      switch (get<5>(result))
+      {
+         case 1: tbldiag.InitTableData<uint8_t>(MonkeyMoore<uint8_t>::equivalency_type(get<1>(result)), littleEndian); break;
+         case 2: tbldiag.InitTableData<uint16_t>(MonkeyMoore<uint16_t>::equivalency_type(get<1>(result)), littleEndian); break;
+         default: tbldiag.InitTableData<uint32_t>(MonkeyMoore<uint32_t>::equivalency_type(get<1>(result)), littleEndian); break;
+      }
+
       tbldiag.CenterOnParent();
       tbldiag.ShowModal();
    }
@@ -652,21 +716,15 @@ void MonkeyFrame::OnListDeleteAll (wxListEvent &event)
 */
 void MonkeyFrame::OnCopyAddress (wxCommandEvent &WXUNUSED(event))
 {
-   wxListCtrl *result_box = GetWindow<wxListCtrl>(MonkeyMoore_Results);
+   MonkeyResultList *result_box = GetWindow<MonkeyResultList>(MonkeyMoore_Results);
    int target = result_box->GetNextItem(-1, wxLIST_NEXT_ALL, wxLIST_STATE_SELECTED);
 
    wxASSERT(result_box->GetItemCount() != 0);
 
    if (target != wxNOT_FOUND)
    {
-      wxListItem sel_item;
-      sel_item.SetId(target);
-      sel_item.SetColumn(0);
-      sel_item.SetMask(wxLIST_MASK_TEXT);
-    
-      result_box->GetItem(sel_item);
-
-      wxString address = sel_item.GetText();
+      // leaves out the byte order, shown after the offset on searches of both
+      wxString address = result_box->GetCellText(target, 0).BeforeFirst(wxT(' '));
 
       if (wxTheClipboard->Open())
       {
@@ -693,7 +751,7 @@ void MonkeyFrame::OnManageCharSeqs (wxCommandEvent &WXUNUSED(event))
 template <typename _DataType>
 void MonkeyFrame::OnClear (wxCommandEvent &WXUNUSED(event))
 {
-   GetWindow<wxListCtrl>(MonkeyMoore_Results)->DeleteAllItems();
+   GetWindow<MonkeyResultList>(MonkeyMoore_Results)->Reset();
    GetWindow<wxStaticText>(MonkeyMoore_Counter)->SetLabel(wxT("0"));
 
    ShowProgressBar(false);
@@ -701,6 +759,7 @@ void MonkeyFrame::OnClear (wxCommandEvent &WXUNUSED(event))
 
    search_done = false;
    lastResults<_DataType>().clear();
+   lastUnique<_DataType>().clear();
 }
 
 void MonkeyFrame::OnOptions (wxCommandEvent &WXUNUSED(event))
@@ -809,7 +868,9 @@ void MonkeyFrame::OnClose (wxCloseEvent &WXUNUSED(event))
 void MonkeyFrame::OnUpdateUI (wxUpdateUIEvent &event)
 {
    bool search_relative = GetValue<bool, wxRadioButton>(MonkeyMoore_RelativeSearch);
-   bool haveResults = searchmode_8bits ? !last_results8.empty() : !last_results16.empty();
+   bool haveResults =
+      searchmode_bits == 8 ? !last_results8.empty() :
+      searchmode_bits == 16 ? !last_results16.empty() : !last_results32.empty();
 
    switch (event.GetId())
    {
@@ -819,6 +880,8 @@ void MonkeyFrame::OnUpdateUI (wxUpdateUIEvent &event)
       case MonkeyMoore_ValueScanSearch:
       case MonkeyMoore_8bitMode:
       case MonkeyMoore_16bitMode:
+      case MonkeyMoore_32bitMode:
+      case MonkeyMoore_AutoWidthMode:
          event.Enable(!search_in_progress);
          break;
 
@@ -884,14 +947,15 @@ void MonkeyFrame::OnUpdateUI (wxUpdateUIEvent &event)
          break;
 
       case MonkeyMoore_EnableByteOrder:
-         event.Enable(!search_in_progress && GetValue<bool, wxRadioButton>(MonkeyMoore_16bitMode));
+         event.Enable(!search_in_progress && !GetValue<bool, wxRadioButton>(MonkeyMoore_8bitMode));
          break;
 
       case MonkeyMoore_ByteOrderLE:
       case MonkeyMoore_ByteOrderBE:
+      case MonkeyMoore_ByteOrderBoth:
          event.Enable(
             !search_in_progress &&
-            GetValue<bool, wxRadioButton>(MonkeyMoore_16bitMode) &&
+            !GetValue<bool, wxRadioButton>(MonkeyMoore_8bitMode) &&
             IsChecked(MonkeyMoore_EnableByteOrder)
          );
          break;
@@ -940,8 +1004,8 @@ bool MonkeyFrame::CheckKeyword (const wxString &kw, const wxChar wc, const wxStr
 
    // ASCII printable characters are in the 0x20 - 0x7A range.
    bool ascii_input =
-      count_if(kw.begin(), kw.end(), bind2nd(less <wxChar>(), 0x20)) == 0 &&
-      count_if(kw.begin(), kw.end(), bind2nd(greater <wxChar>(), 0x7A)) == 0;
+      count_if(kw.begin(), kw.end(), [] (wxChar c) { return c < 0x20; }) == 0 &&
+      count_if(kw.begin(), kw.end(), [] (wxChar c) { return c > 0x7A; }) == 0;
 
    int n_wildcards = count(kw.begin(), kw.end(), wc);
 
@@ -954,8 +1018,8 @@ bool MonkeyFrame::CheckKeyword (const wxString &kw, const wxChar wc, const wxStr
 
    if (!custom_cp && ascii_input)
    {
-      int n_lower = static_cast <int> (count_if(kw.begin(), kw.end(), is_lower));
-      int n_upper = static_cast <int> (count_if(kw.begin(), kw.end(), is_upper));
+      int n_lower = static_cast <int> (count_if(kw.begin(), kw.end(), [] (wxChar c) { return is_lower(c); }));
+      int n_upper = static_cast <int> (count_if(kw.begin(), kw.end(), [] (wxChar c) { return is_upper(c); }));
 
       // we need 3 or more characters with the SAME capitalization
       if (n_lower && n_upper)
@@ -968,7 +1032,7 @@ bool MonkeyFrame::CheckKeyword (const wxString &kw, const wxChar wc, const wxStr
       }
       else
       {
-         int n_letters = static_cast <int> (count_if(kw.begin(), kw.end(), is_alpha()));
+         int n_letters = static_cast <int> (count_if(kw.begin(), kw.end(), [] (wxChar c) { return is_alpha()(c); }));
 
          // we still need 3 or more characters, not counting wildcards
          if (n_letters < 3)
@@ -979,7 +1043,7 @@ bool MonkeyFrame::CheckKeyword (const wxString &kw, const wxChar wc, const wxStr
       }
 
       // checks if we have only valid characters (letters and wildcards)
-      if (count_if(kw.begin(), kw.end(), not1(is_alpha())) > n_wildcards)
+      if (count_if(kw.begin(), kw.end(), [] (wxChar c) { return !is_alpha()(c); }) > n_wildcards)
       {
          ShowWarning(MM_WARNING_KWORDINVALIDCHARS);
          return false;
@@ -1060,15 +1124,14 @@ template <typename _DataType>
 bool MonkeyFrame::StartSearchThread (SearchParameters &p)
 {
    SearchThread<_DataType> *worker =
-      new SearchThread<_DataType>(p, lastResults<_DataType>(), prefs, this);
+      new SearchThread<_DataType>(p, prefs, this);
 
    if (worker->Create() == wxTHREAD_NO_ERROR)
    {
       wxBitmapButton *cancel_search = GetWindow<wxBitmapButton>(MonkeyMoore_Cancel);
       cancel_search->SetBitmapLabel(images.GetBitmap(MonkeyBmp_Cancel));
 
-      wxListCtrl *result_box = GetWindow<wxListCtrl>(MonkeyMoore_Results);
-      if (result_box->GetItemCount() != 0) result_box->DeleteAllItems();
+      GetWindow<MonkeyResultList>(MonkeyMoore_Results)->Reset();
 
       GetWindow<wxStaticText>(MonkeyMoore_Counter)->SetLabel(wxT("0"));
       GetWindow<wxStaticText>(MonkeyMoore_ElapsedTime)->SetLabel(_("Waiting..."));
@@ -1077,12 +1140,14 @@ bool MonkeyFrame::StartSearchThread (SearchParameters &p)
       Bind(mmEVT_SEARCHTHREAD_UPDATE, &MonkeyFrame::OnThreadUpdate<_DataType>, this);
       Bind(mmEVT_SEARCHTHREAD_COMPLETED, &MonkeyFrame::OnThreadCompleted<_DataType>, this);
       Bind(mmEVT_SEARCHTHREAD_ABORTED, &MonkeyFrame::OnThreadAborted<_DataType>, this);
+      Bind(mmEVT_SEARCHTHREAD_RESULTS, &MonkeyFrame::OnThreadResults<_DataType>, this);
 
       SetCurrentProgress(0);
       ShowProgressBar();
       chronometer.Start();
       
       lastResults<_DataType>().clear();
+      lastUnique<_DataType>().clear();
       
       search_in_progress = true;
       worker->SetPriority(25);
@@ -1101,73 +1166,80 @@ bool MonkeyFrame::StartSearchThread (SearchParameters &p)
 
 /**
 * Display the search results.
-* @param r search results
+* @param showAll if true, results with repeated values are shown as well
 */
 template <typename _DataType>
 void MonkeyFrame::ShowResults (bool showAll)
 {
-   wxListCtrl *result_box = GetWindow<wxListCtrl>(MonkeyMoore_Results);
-   bool search_relative = GetValue<bool, wxRadioButton>(MonkeyMoore_RelativeSearch);
-
-   uint32_t numBytes = static_cast<uint32_t>(sizeof(_DataType)) * 2;
-   wxString hexValueFmt = wxString::Format(wxT("%%c=%%0%uX "), numBytes);
+   MonkeyResultList *result_box = GetWindow<MonkeyResultList>(MonkeyMoore_Results);
 
-   vector<MonkeyMoore<_DataType>::equivalency_type> unique;
-   auto r = lastResults<_DataType>();
+   const size_t shown = showAll ? lastResults<_DataType>().size() : lastUnique<_DataType>().size();
+   const bool hex_offset = prefs.getBool(wxT("settings/display-offset-mode"), wxT("hex"));
 
-   // index of the element being inserted in the wxListCtrl
-   long curListIndex = 0;
-
-   if (!r.empty())
-   {
-      if (result_box->GetItemCount() != 0)
-         result_box->DeleteAllItems();
+   // results whose values were already listed are left out, unless all of them are shown
+   auto index = [this, showAll] (long item) -> uint32_t {
+      return showAll ? static_cast<uint32_t>(item) : lastUnique<_DataType>().first_results()[item];
+   };
 
-      result_box->Freeze();
+   result_box->SetSource(static_cast<long>(shown),
+      [this, index, hex_offset] (long item, long column) { return ResultText<_DataType>(index(item), column, hex_offset); },
+      index);
 
-      for (uint32_t i = 0; i < r.size(); i++)
-      {
-         MonkeyMoore<_DataType>::equivalency_type &t = get<1>(r[i]);
-
-         // if another result with the same values was already inserted in the list, don't insert
-         if (!count(unique.begin(), unique.end(), t))
-         {
-            if (!showAll)
-               unique.push_back(t);
+   wxString counterLabel = wxString::Format(wxT("%d"), static_cast<int>(shown));
+   GetWindow<wxStaticText>(MonkeyMoore_Counter)->SetLabel(counterLabel);
+}
 
-            bool hex_offset = prefs.getBool(wxT("settings/display-offset-mode"), wxT("hex"));
-            wxString offset = wxString::Format(hex_offset ? wxT("0x%I64X") : wxT("%I64d"), get<0>(r[i]));
+/**
+* Generates the text of a search result, as shown in the results list.
+* @param resultIndex index of the result in the last results
+* @param column list column (offset, values and preview, or offset and preview)
+* @param hexOffset shows the offset in hexadecimal
+* @return Text of the column.
+*/
+template <typename _DataType>
+wxString MonkeyFrame::ResultText (uint32_t resultIndex, long column, bool hexOffset)
+{
+   const auto &r = lastResults<_DataType>()[resultIndex];
 
-            result_box->InsertItem(curListIndex, offset);
-            result_box->SetItemData(curListIndex, i);
+   if (column == 0)
+   {
+      wxString offset = wxString::Format(hexOffset ? wxT("0x%I64X") : wxT("%I64d"), get<0>(r));
 
-            wxString values;
-            const MonkeyMoore<_DataType>::equivalency_type &ref = get<1>(r[i]);
+      const bool bothOrders = get<5>(r) > 1 && byteorder == SearchParameters::both_endian;
+      const wxChar *order = get<4>(r) == SearchParameters::little_endian ? wxT("LE") : wxT("BE");
 
-            for (MonkeyMoore<_DataType>::equivalency_type::const_iterator j = ref.cbegin(); j != ref.cend(); j++)
-            {
-               // swap bytes acording to the endianness the search was performed on
-               _DataType value = byteorder_little ?
-                  swap_on_le<_DataType>(j->second) :
-                  swap_on_be<_DataType>(j->second);
+      // searching every width (or both byte orders), each result tells which one it was found in
+      if (searchmode_bits == 0)
+         offset += bothOrders ?
+            wxString::Format(wxT(" (%d-bit %s)"), get<5>(r) * 8, order) :
+            wxString::Format(wxT(" (%d-bit)"), get<5>(r) * 8);
+      else if (bothOrders)
+         offset += wxString::Format(wxT(" (%s)"), order);
 
-               values += wxString::Format(hexValueFmt, (*j).first, value);
-            }
+      return offset;
+   }
 
-            result_box->SetItem(curListIndex, 1, values);
-            result_box->SetItem(curListIndex, search_relative ? 2 : 1, get<2>(r[i]));
+   // the values column is only there on relative searches
+   if (column == GetWindow<wxListCtrl>(MonkeyMoore_Results)->GetColumnCount() - 1)
+      return get<2>(r);
 
-            curListIndex++;
-         }
-      }
+   uint32_t numBytes = static_cast<uint32_t>(get<5>(r)) * 2;
+   wxString hexValueFmt = wxString::Format(wxT("%%c=%%0%uX "), numBytes);
 
-      result_box->Thaw();
+   wxString values;
+   const auto ref = get<1>(r).expand();
 
-      AdjustResultColumns(true);
+   for (auto j = ref.cbegin(); j != ref.cend(); j++)
+   {
+      // swap bytes acording to the endianness (and width) the result was found in
+      _DataType value = get<4>(r) == SearchParameters::little_endian ?
+         swap_on_le<_DataType>(j->second, get<5>(r)) :
+         swap_on_be<_DataType>(j->second, get<5>(r));
 
-      wxString counterLabel = wxString::Format(wxT("%d"), static_cast<int>(showAll ? r.size() : unique.size()));
-      GetWindow<wxStaticText>(MonkeyMoore_Counter)->SetLabel(counterLabel);
+      values += wxString::Format(hexValueFmt, static_cast<wxChar>(j->first), value);
    }
+
+   return values;
 }
 
 template <typename _DataType>
@@ -1175,7 +1247,13 @@ void MonkeyFrame::OnThreadUpdate (wxThreadEvent &event)
 {
    if (!search_was_aborted)
    {
-      GetWindow<wxStaticText>(MonkeyMoore_ElapsedTime)->SetLabel(event.GetString());
+      wxString label = event.GetString();
+      const SearchStats::Summary stats = event.GetPayload<SearchStats::Summary>();
+
+      if (stats.totals.blocks)
+         label += wxString::Format(wxT(" (%.1f MB/s)"), stats.GetBytesPerSecond() / 1048576);
+
+      GetWindow<wxStaticText>(MonkeyMoore_ElapsedTime)->SetLabel(label);
       SetCurrentProgress(event.GetInt());
    }
 }
@@ -1199,14 +1277,41 @@ void MonkeyFrame::OnThreadCompleted (wxThreadEvent &WXUNUSED(event))
       GetWindow<wxStaticText>(MonkeyMoore_ElapsedTime)->SetLabel(format) :
       GetWindow<wxStaticText>(MonkeyMoore_ElapsedTime)->SetLabel(_("No results found."));
 
-   bool showAll = IsChecked(MonkeyMoore_AllResults);
-   
-   ShowResults<_DataType>(showAll);
+   ShowResults<_DataType>(IsChecked(MonkeyMoore_AllResults));
+   AdjustResultColumns(true);
+
+   UnbindThreadEvents<_DataType>();
 
    wxBitmapButton *cancel_search = GetWindow<wxBitmapButton>(MonkeyMoore_Cancel);
    cancel_search->SetBitmapLabel(images.GetBitmap(MonkeyBmp_Done));
 }
 
+/**
+* Receives results while the search is still running, and lists them right away.
+*/
+template <typename _DataType>
+void MonkeyFrame::OnThreadResults (wxThreadEvent &event)
+{
+   if (search_was_aborted)
+      return;
+
+   auto &r = lastResults<_DataType>();
+   auto &unique = lastUnique<_DataType>();
+
+   const auto found = event.GetPayload<vector<typename SearchThread<_DataType>::result_type>>();
+
+   for (auto i = found.begin(); i != found.end(); ++i)
+   {
+      r.push_back(*i);
+
+      // repeated values are found out as results come (the same values
+      // stored in different byte orders or widths aren't the same table)
+      unique.push_back(get<1>(*i), get<4>(*i) + 2 * get<5>(*i));
+   }
+
+   ShowResults<_DataType>(IsChecked(MonkeyMoore_AllResults));
+}
+
 template <typename _DataType>
 void MonkeyFrame::OnThreadAborted (wxThreadEvent &WXUNUSED(event))
 {
@@ -1218,9 +1323,27 @@ void MonkeyFrame::OnThreadAborted (wxThreadEvent &WXUNUSED(event))
    GetWindow<wxStaticText>(MonkeyMoore_ElapsedTime)->SetLabel(_("Search was aborted."));
 
    lastResults<_DataType>().clear();
+   lastUnique<_DataType>().clear();
+
+   GetWindow<MonkeyResultList>(MonkeyMoore_Results)->Reset();
+   GetWindow<wxStaticText>(MonkeyMoore_Counter)->SetLabel(wxT("0"));
+
+   UnbindThreadEvents<_DataType>();
 
    wxBitmapButton *cancel_search = GetWindow<wxBitmapButton>(MonkeyMoore_Cancel);
    cancel_search->SetBitmapLabel(images.GetBitmap(MonkeyBmp_Done));
 
    SetCurrentProgress(0);
+}
+
+/**
+* Detaches the finished search thread notifications, which are bound again by the next search.
+*/
+template <typename _DataType>
+void MonkeyFrame::UnbindThreadEvents ()
+{
+   Unbind(mmEVT_SEARCHTHREAD_UPDATE, &MonkeyFrame::OnThreadUpdate<_DataType>, this);
+   Unbind(mmEVT_SEARCHTHREAD_COMPLETED, &MonkeyFrame::OnThreadCompleted<_DataType>, this);
+   Unbind(mmEVT_SEARCHTHREAD_ABORTED, &MonkeyFrame::OnThreadAborted<_DataType>, this);
+   Unbind(mmEVT_SEARCHTHREAD_RESULTS, &MonkeyFrame::OnThreadResults<_DataType>, this);
 }
\ No newline at end of file
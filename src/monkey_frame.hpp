@@ -33,16 +33,24 @@
 #include "byteswap.hpp"
 #include "monkey_moore.hpp"
 #include "monkey_prefs.hpp"
+#include "monkey_results.hpp"
 
 #include <wx/imaglist.h>
 #include <wx/listctrl.h>
 #include <vector>
+#include <tuple>
 #include <utility>
 #include <mutex>
 
+// results of a search, as SearchEngine<_DataType>::result_type
+// (offset, equivalency, preview, keyword index, byte order and data width)
+template <typename _DataType>
+using result_type = std::tuple<wxFileOffset, typename MonkeyMoore<_DataType>::equivalency_type, wxString, int, int, int>;
+
 // typedefs to prevent lenghty code
-typedef std::tuple<wxFileOffset, MonkeyMoore<uint8_t>::equivalency_type, wxString> result_type8;
-typedef std::tuple<wxFileOffset, MonkeyMoore<uint16_t>::equivalency_type, wxString> result_type16;
+typedef result_type<uint8_t> result_type8;
+typedef result_type<uint16_t> result_type16;
+typedef result_type<uint32_t> result_type32;
 
 struct SearchParameters;
 
@@ -85,6 +93,7 @@ public:
    template <typename _DataType> void OnThreadUpdate (wxThreadEvent &event);
    template <typename _DataType> void OnThreadCompleted (wxThreadEvent &event);
    template <typename _DataType> void OnThreadAborted (wxThreadEvent &event);
+   template <typename _DataType> void OnThreadResults (wxThreadEvent &event);
 
    /**
    * Sets the progress bar percentage.
@@ -120,9 +129,15 @@ private:
    template <typename _DataType>
       bool StartSearchThread (SearchParameters &p);
 
+   template <typename _DataType>
+      void UnbindThreadEvents ();
+
    template <typename _DataType>
       void ShowResults (bool showAll = true);
 
+   template <typename _DataType>
+      wxString ResultText (uint32_t resultIndex, long column, bool hexOffset);
+
    /**
    * Get a pointer to the widget with the specified ID.
    * @tparam _Type Type of the widget (must be a wxWindow or a child from it)
@@ -152,17 +167,24 @@ private:
    /**
    * Get a reference to a vector containing the last search results.
    * It returns the correct type/data depending on the type specified.
-   * @tparam _Datatype (must be either u8 or u16)
+   * @tparam _Datatype (must be either u8, u16 or u32)
    * @return A vector containing the last results of _Type
    */
    template <typename _DataType>
-      std::vector<std::tuple<wxFileOffset,
-         typename MonkeyMoore<_DataType>::equivalency_type, wxString>> &lastResults();
+      std::vector<result_type<_DataType>> &lastResults();
+
+   /**
+   * Get a reference to the index of repeated values among the last search results.
+   * @tparam _Datatype (must be either u8, u16 or u32)
+   * @return The index matching lastResults<_DataType>()
+   */
+   template <typename _DataType>
+      equivalency_index<_DataType> &lastUnique();
 
    int progressBoxHeight;                     /**< Height of the progress box in pixels */
 
-   bool searchmode_8bits;                     /**< 8-bit search mode is selected?       */
-   bool byteorder_little;                     /**< Is byte order set to little endian?  */
+   int searchmode_bits;                       /**< Width of the selected search mode (0: all) */
+   int byteorder;                             /**< Byte order (as in SearchParameters)  */
    bool advanced_shown;                       /**< Is the advanced box shown?           */
    bool search_done;                          /**< Is the search done?                  */
    bool search_in_progress;                   /**< Is the search in progress?           */
@@ -175,6 +197,11 @@ private:
 
    std::vector<result_type8> last_results8;   /**< Results from the last 8-bit search   */
    std::vector<result_type16> last_results16; /**< Results from the last 16-bit search  */
+   std::vector<result_type32> last_results32; /**< Results from the last 32-bit (or auto) search */
+
+   equivalency_index<uint8_t> last_unique8;   /**< Repeated values on the 8-bit results  */
+   equivalency_index<uint16_t> last_unique16; /**< Repeated values on the 16-bit results */
+   equivalency_index<uint32_t> last_unique32; /**< Repeated values on the 32-bit results */
 
    DECLARE_EVENT_TABLE();
 };
@@ -0,0 +1,76 @@
+/*
+ * Monkey-Moore - A simple and powerful relative search tool
+ * Copyright (C) 2007 Ricardo J. Ricken (Darkl0rd)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef MONKEY_LANES_HPP
+#define MONKEY_LANES_HPP
+
+#include "byteswap.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+/** byte orders multibyte values may be loaded with: the one they're stored in
+(the native one, as far as the system is concerned), the swapped one, or both */
+enum lane_order { native_order = 1, swapped_order = 2, both_orders = native_order | swapped_order };
+
+/** values of each lane searched before moving on to the next lane, small
+enough for the bytes they're read from to stay in the cache meanwhile */
+const long lane_chunk = 4096;
+
+/**
+* Multibyte values stored one after the other from any byte (a lane), as seen by
+* the search. A block holds one lane per alignment, all of them read out of the same
+* bytes: values are loaded unaligned and byte swapped as they're read, so the block
+* is never copied nor modified.
+* @tparam Ty value type
+* @tparam Swap whether the bytes of each value are swapped when it's loaded
+*/
+template <class Ty, bool Swap> class lane_view
+{
+public:
+   /**
+   * Constructor.
+   * @param bytes first byte of the first value
+   */
+   explicit lane_view (const uint8_t *bytes) : bytes(bytes) { }
+
+   /**
+   * Loads a value.
+   * @param i value index
+   * @return The value, in the byte order of the system.
+   */
+   Ty operator[] (long i) const
+   {
+      Ty value;
+      std::memcpy(&value, bytes + i * static_cast <long> (sizeof(Ty)), sizeof(Ty));
+
+      return Swap ? swap_always<Ty>(value) : value;
+   }
+
+   /**
+   * Moves the view forward.
+   * @param i number of values skipped
+   * @return A view starting at the given value.
+   */
+   lane_view operator+ (long i) const { return lane_view(bytes + i * static_cast <long> (sizeof(Ty))); }
+
+private:
+   const uint8_t *bytes;  /**< first byte of the first value */
+};
+
+#endif //~MONKEY_LANES_HPP
@@ -0,0 +1,141 @@
+/*
+ * Monkey-Moore - A simple and powerful relative search tool
+ * Copyright (C) 2007 Ricardo J. Ricken (Darkl0rd)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef MONKEY_MAPPING_HPP
+#define MONKEY_MAPPING_HPP
+
+#include <wx/wxprec.h>
+
+#ifdef __BORLANDC__
+   #pragma hdrstop
+#endif
+
+#ifndef WX_PRECOMP
+   #include <wx/wx.h>
+#endif
+
+#include <wx/file.h>
+#include <cstdint>
+
+#ifdef __WINDOWS__
+   #include <io.h>
+   #include <wx/msw/wrapwin.h>
+#else
+   #include <sys/mman.h>
+   #include <sys/stat.h>
+#endif
+
+/**
+* Read-only memory mapping of a whole file, so it can be searched directly
+* on the mapped pages instead of being copied block by block into the heap.
+* Mapping is not always possible (pipes, devices, 32-bit address space
+* exhaustion...), so IsOk() must be checked and buffered reads used instead.
+*/
+class FileMapping
+{
+public:
+   /**
+   * Constructor. Tries to map the file opened by the given wxFile.
+   * @param file an opened file, which must outlive the mapping
+   */
+   explicit FileMapping (wxFile &file) : m_data(0), m_length(0)
+   {
+      const wxFileOffset length = file.Length();
+
+      // empty files can't be mapped, and too big ones don't fit in the address space
+      if (length <= 0 || static_cast<uint64_t>(length) > SIZE_MAX)
+         return;
+
+#ifdef __WINDOWS__
+      HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(file.fd()));
+
+      if (handle == INVALID_HANDLE_VALUE || GetFileType(handle) != FILE_TYPE_DISK)
+         return;
+
+      HANDLE mapping = CreateFileMapping(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+
+      if (!mapping)
+         return;
+
+      // the view keeps its own reference to the mapping object
+      void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+      CloseHandle(mapping);
+
+      if (!view)
+         return;
+#else
+      struct stat info;
+
+      if (fstat(file.fd(), &info) != 0 || !S_ISREG(info.st_mode))
+         return;
+
+      void *view = mmap(0, static_cast<size_t>(length), PROT_READ, MAP_PRIVATE, file.fd(), 0);
+
+      if (view == MAP_FAILED)
+         return;
+
+      // the file is scanned from start to end, so ask for aggressive read-ahead
+      madvise(view, static_cast<size_t>(length), MADV_SEQUENTIAL);
+#endif
+
+      m_data = static_cast<const uint8_t *>(view);
+      m_length = length;
+   }
+
+   /**
+   * Destructor. Unmaps the file.
+   */
+   ~FileMapping ()
+   {
+      if (!m_data)
+         return;
+
+#ifdef __WINDOWS__
+      UnmapViewOfFile(m_data);
+#else
+      munmap(const_cast<uint8_t *>(m_data), static_cast<size_t>(m_length));
+#endif
+   }
+
+   /**
+   * Finds out whether the file was mapped or not.
+   * @return True if the mapped data is available.
+   */
+   bool IsOk () const { return m_data != 0; }
+
+   /**
+   * Returns a pointer to the mapped data.
+   * @return Pointer to the first byte of the file.
+   */
+   const uint8_t *GetData () const { return m_data; }
+
+   /**
+   * Returns the number of mapped bytes.
+   * @return Length of the file.
+   */
+   wxFileOffset GetLength () const { return m_length; }
+
+   FileMapping (const FileMapping &) = delete;
+   FileMapping &operator= (const FileMapping &) = delete;
+
+private:
+   const uint8_t *m_data;   /**< first mapped byte */
+   wxFileOffset m_length;   /**< mapped length     */
+};
+
+#endif //~MONKEY_MAPPING_HPP
@@ -19,22 +19,19 @@
 #ifndef MONKEY_MOORE_HPP
 #define MONKEY_MOORE_HPP
 
-#include <wx/wxprec.h>
-
-#ifdef __BORLANDC__
-#pragma hdrstop
-#endif
-
-#ifndef WX_PRECOMP
-#include <wx/wx.h>
-#endif
-
 #include "object_pred.hpp"
-
-#include <wx/wxchar.h>
+#include "monkey_simd.hpp"
+#include "monkey_equivalency.hpp"
+#include "monkey_charset.hpp"
+#include "monkey_skip.hpp"
+#include "monkey_lanes.hpp"
+
+#include <cassert>
+#include <cstdint>
 #include <memory>
 #include <map>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <algorithm>
 #include <vector>
@@ -42,6 +39,7 @@
 
 typedef unsigned char u8;
 typedef unsigned short u16;
+typedef unsigned int u32;
 
 /**
 * Manages and performs relative searchs.
@@ -55,15 +53,11 @@ public:
    * @param wildcard user defined wildcard
    * @param pattern custom character set
    */
-   MonkeyMoore (const wxString &keyword, const wxChar &wildcard = 0, const wxString &pattern = wxT(""))
-   : card(wildcard), type(none)
+   MonkeyMoore (std::u32string_view keyword, char32_t wildcard = 0, std::u32string_view pattern = std::u32string_view())
+   : type(none), card(wildcard)
    {
-      wxASSERT(keyword.length() != 0);
-
-      //auto patternStr = pattern.c_str();
-      //const wxChar *patternPtr = pattern.length() ? patternStr.AsInternal() : 0;
-
-      init(keyword.c_str(), keyword.length(), pattern.c_str());
+      assert(keyword.length() != 0);
+      init(keyword, pattern);
    }
 
    /**
@@ -74,16 +68,16 @@ public:
    MonkeyMoore (const std::vector <short> &vals)
    : card(0)
    {
-      wxASSERT(vals.size() != 0);
+      assert(vals.size() != 0);
       type = value_scan;
 
-      const int vsize = static_cast <int> (vals.size());
-      std::unique_ptr<wxChar[]> temp(new wxChar[vsize]);
+      // negative values wrap around, which keeps their differences
+      std::u32string temp(vals.size(), 0);
 
-      for (int i = 0; i < vsize; i++)
-         temp[i] = static_cast <wxChar> (vals[i]);
+      for (size_t i = 0; i < vals.size(); i++)
+         temp[i] = static_cast <char32_t> (vals[i]);
 
-      init(temp.get(), vsize, 0); 
+      init(temp, std::u32string_view());
    }
 
    /**
@@ -93,20 +87,17 @@ public:
    {
       delete [] key;
       delete [] key_tbl;
-      delete [] skip;
 
       if (type == wildcard_relative)
       {
          delete [] mdkey;
          delete [] wc_pos;
+         delete [] prev_pos;
          delete [] cards;
       }
-
-      if (cplen)
-         delete [] char_pattern;
    }
 
-   typedef std::map <wxChar, Ty> equivalency_type;
+   typedef equivalency_table <Ty> equivalency_type;
    typedef std::pair <long, equivalency_type> relative_type;
 
    /**
@@ -114,16 +105,176 @@ public:
    * constructor called during instantiation.
    * @param data byte array to search on
    * @param len data length
+   * @param candidates if given, incremented by the number of positions compared against the key
+   * @return Search results.
+   */
+   std::vector <relative_type> search (const Ty *data, long len, uint64_t *candidates = 0)
+   {
+      uint64_t compared = 0;
+      std::vector <relative_type> results;
+
+      if (type == wildcard_relative)
+         monkey_moore_wc(data, len, 0, len, results, compared);
+
+      // 8-bit data can be prefiltered many positions at a time
+      else if (sizeof(Ty) == 1 && klen > 1)
+         results = monkey_moore_simd(data, len, select_delta_scan(), compared);
+      else
+         monkey_moore(data, len, 0, len, results, compared);
+
+      if (candidates)
+         *candidates += compared;
+
+      return results;
+   }
+
+   /**
+   * Performs a simple relative search (or value scan) with the given prefilter on 8-bit
+   * data, or with the Boyer-Moore loop alone, instead of the fastest way available.
+   * It's meant to check each of them against the others.
+   * @param data byte array to search on
+   * @param len data length
+   * @param scan delta prefilter, or 0 for none
    * @return Search results.
    */
-   std::vector <relative_type> search (const Ty *data, long len)
+   std::vector <relative_type> search_with (const Ty *data, long len, delta_scan_type scan)
+   {
+      assert(type != wildcard_relative);
+
+      uint64_t compared = 0;
+      std::vector <relative_type> results;
+
+      if (scan && sizeof(Ty) == 1 && klen > 1)
+         results = monkey_moore_simd(data, len, scan, compared);
+      else
+         monkey_moore(data, len, 0, len, results, compared);
+
+      return results;
+   }
+
+   /**
+   * Performs the search on multibyte values starting on any byte. Each alignment
+   * (lane) is searched in turn, a chunk of values at a time, so the bytes are
+   * gone through once, while they're still cached, instead of once per lane.
+   * @param bytes byte array to search on
+   * @param size number of bytes
+   * @param swap whether the bytes of each value are swapped as it's loaded
+   * @param candidates if given, incremented by the number of positions compared against the key
+   * @return Search results, with offsets in bytes, ordered by offset.
+   */
+   std::vector <relative_type> search_lanes (const uint8_t *bytes, long size, bool swap, uint64_t *candidates = 0)
    {
-      return type == simple_relative || type == value_scan ?
-         monkey_moore(data, len) :
-         monkey_moore_wc(data, len);
+      std::vector <relative_type> results[2];
+      search_lanes(bytes, size, swap ? swapped_order : native_order, results, candidates);
+
+      return std::move(results[swap ? 1 : 0]);
+   }
+
+   /**
+   * Performs the search on multibyte values starting on any byte, in one byte order
+   * or both: when it's both, each chunk is searched as native values and as swapped
+   * ones while it's still cached, instead of going through the bytes twice.
+   * @param bytes byte array to search on
+   * @param size number of bytes
+   * @param orders byte orders the values are loaded with (native_order, swapped_order or both_orders)
+   * @param results results of each byte order (the native one first), with offsets in bytes, ordered by offset
+   * @param candidates if given, incremented by the number of positions compared against the key
+   */
+   void search_lanes (const uint8_t *bytes, long size, int orders, std::vector <relative_type> *results, uint64_t *candidates = 0)
+   {
+      const long lanes = sizeof(Ty);
+      uint64_t compared = 0;
+
+      std::vector <relative_type> found[2][sizeof(Ty)];
+      long count[sizeof(Ty)], next[2][sizeof(Ty)];
+
+      for (long lane = 0; lane < lanes; lane++)
+      {
+         count[lane] = size > lane ? (size - lane) / lanes : 0;
+         next[0][lane] = next[1][lane] = 0;
+      }
+
+      // the first lane is the longest one
+      for (long end = lane_chunk; end - lane_chunk < count[0]; end += lane_chunk)
+      {
+         for (long lane = 0; lane < lanes; lane++)
+         {
+            if (orders & native_order)
+               next[0][lane] = search_lane <false> (bytes + lane, count[lane], next[0][lane], end, found[0][lane], compared);
+
+            if (orders & swapped_order)
+               next[1][lane] = search_lane <true> (bytes + lane, count[lane], next[1][lane], end, found[1][lane], compared);
+         }
+      }
+
+      for (int order = 0; order < 2; order++)
+      {
+         results[order].clear();
+
+         for (long lane = 0; lane < lanes; lane++)
+            for (auto i = found[order][lane].begin(); i != found[order][lane].end(); ++i)
+               results[order].push_back(std::make_pair(lane + i->first * lanes, i->second));
+
+         std::sort(results[order].begin(), results[order].end(), [] (const relative_type &a, const relative_type &b) {
+            return a.first < b.first;
+         });
+      }
+
+      if (candidates)
+         *candidates += compared;
+   }
+
+   /**
+   * Finds out whether the key is matched by its relative differences alone,
+   * which isn't the case when it has wildcards or capitalization changes.
+   * @return True if the key is a simple relative or value scan one.
+   */
+   bool is_simple () const { return type != wildcard_relative; }
+
+   /**
+   * Returns the key length.
+   * @return Number of characters (or values) in the key.
+   */
+   long length () const { return klen; }
+
+   /**
+   * Returns the relative difference between a key position and the previous one.
+   * @param pos key position, in the [1, length()) range
+   * @return The relative difference.
+   */
+   int difference (long pos) const { return key_tbl[pos]; }
+
+   /**
+   * Builds the equivalency table of a match found by other means.
+   * @param match pointer (or lane_view) to the first value of the match
+   * @return The equivalency table.
+   */
+   template <class View> equivalency_type equivalency (const View &match)
+   {
+      return type == wildcard_relative ? make_equivalency_wc(match) : make_equivalency(match);
    }
 
 private:
+   /**
+   * Searches the next chunk of a lane.
+   * @tparam Swap whether the bytes of each value are swapped as it's loaded
+   * @param bytes first byte of the lane
+   * @param count number of values in the lane
+   * @param from first position tried
+   * @param to positions from here on are left for the next chunk
+   * @param results where the relative values found are appended to
+   * @param compared incremented by the number of positions compared
+   * @return The position the search stopped at, where the next chunk resumes it.
+   */
+   template <bool Swap> long search_lane (const uint8_t *bytes, long count, long from, long to, std::vector <relative_type> &results, uint64_t &compared)
+   {
+      const lane_view <Ty, Swap> data(bytes);
+
+      return type == wildcard_relative ?
+         monkey_moore_wc(data, count, from, to, results, compared) :
+         monkey_moore(data, count, from, to, results, compared);
+   }
+
    /**
    * Preprocess the search key and build the search tables.
    */
@@ -139,31 +290,23 @@ private:
 
       // maps the character pattern positions for easy access
       if (cplen)
-      {
-         for (int i = 0; i < cplen; i++)
-            cp_pos[char_pattern[i]] = i;
-      }
+         cp_pos.assign(*charset);
 
       if (type == simple_relative || type == value_scan)
       {
          key_tbl = new int[klen];
          !cplen ? calc_reltable(key, key_tbl, klen) : calc_reltable_cp(key, key_tbl, klen);
 
-         // prepares the jump table
-         std::fill(skip, skip + sklen, static_cast <char> (klen - 1));
-
-         // negative indices are mapped on positions 0-255, and positive ones on 256-511
-         for (int i = klen - 1; i > 0; i--)
-         {
-            int index = key_tbl[i] > 0 ? (sklen / 2) + key_tbl[i] : -key_tbl[i];
+         // prepares the jump table. the last difference is left
+         // out, since a mismatch there means it can't be it.
+         skip.reset(klen);
 
-            if (skip[index] == klen - 1)
-               skip[index] = static_cast <char> (klen - i - 1);
-         }
+         for (int i = klen - 2; i > 0; i--)
+            skip.insert(key_tbl[i], klen - i - 1);
       }
       else // type == wildcard_relative
       {
-         mdkey = new wxChar[klen];
+         mdkey = new char32_t[klen];
          std::copy(key, key + klen, mdkey);
 
          if (!cplen)
@@ -193,7 +336,7 @@ private:
 
          // --- builds the relative difference table
          n_wildcards = static_cast <int> (std::count(mdkey, mdkey + klen, card));
-         wxChar *mdkey_pure = new wxChar[klen - n_wildcards];
+         char32_t *mdkey_pure = new char32_t[klen - n_wildcards];
 
          for (int i = 0, j = 0; i < klen; i++)
             if (wc_pos[i]) mdkey_pure[j++] = mdkey[i];
@@ -209,23 +352,42 @@ private:
          for (int i = klen - 1, j = klen - n_wildcards - 1; i >= 0; i--)
             key_tbl[i] = wc_pos[i] ? key_tbl_tmp[j--] : 0;
 
-         // --- builds the jump table
-         std::fill(skip, skip + sklen, static_cast<char> (klen - 1));
+         // --- builds the previous non-wildcard position table
+         // wildcards are marked with -2, and the first non-wildcard with -1
+         prev_pos = new int[klen];
 
-         // negative indices are mapped on positions 0-255, and positive ones on 256-511
-         for (int i = klen - 1; i > 0; i--)
+         for (int i = 0, last = -1; i < klen; i++)
          {
-            int index = key_tbl[i] > 0 ? (sklen / 2) + key_tbl[i] : -key_tbl[i];
-
-            if (skip[index] == klen - 1)
-               skip[index] = static_cast <char> (klen - std::count(mdkey + i + 1, mdkey + klen, card) - i - 1);
+            prev_pos[i] = wc_pos[i] ? last : -2;
+            if (wc_pos[i]) last = i;
          }
 
+         last_pos = klen - 1;
+         for (; last_pos > 0 && !wc_pos[last_pos]; last_pos--);
+
+         // --- builds the jump table
+         // only real differences go in (no wildcards, nor the first and last ones).
+         skip.reset(klen);
+
+         for (int i = last_pos - 1; i > 0; i--)
+            if (prev_pos[i] >= 0)
+               skip.insert(key_tbl[i], klen - i - 1);
+
          // --- builds the wildcard jump table
-         cards = new u8[klen];
+         // the jump table assumes the key shifted over the data keeps the same
+         // differences, which stops being true once a wildcard gets in the way;
+         // for each position, this is how far it holds.
+         cards = new int[klen];
+
+         for (int i = 0; i < klen; i++)
+         {
+            int jump = 1;
 
-         for (int i = klen - 1; i >= 0; i--)
-            cards[i] = mdkey[i] == card ? 1 : static_cast <u8> (std::max<int>(i - find_last(mdkey, mdkey + i, card) - 1, 1));
+            if (prev_pos[i] >= 0)
+               for (; prev_pos[i] - jump >= 0 && prev_pos[i - jump] == prev_pos[i] - jump; jump++);
+
+            cards[i] = jump;
+         }
 
          // --- clean up
          delete [] mdkey_pure;
@@ -235,213 +397,225 @@ private:
 
    /**
    * Performs some initialization stuff.
-   * @param kw pointer to keyword
-   * @param ksz keyword length
-   * @param cp pointer to character pattern
+   * @param kw keyword
+   * @param cp character pattern (empty when not used)
    */
-   void init (const wxChar *kw, const int ksz, const wxChar *cp)
+   void init (std::u32string_view kw, std::u32string_view cp)
    {
-      key = mdkey = char_pattern = 0;
+      key = mdkey = 0;
       klen = cplen = 0;
       key_tbl = 0;
       wc_pos = 0;
+      prev_pos = 0;
       cards = 0;
-      skip = 0;
       case_change = false;
 
-      klen = ksz;
-      key = new wxChar[klen];
-      std::copy(kw, kw + klen, key);
+      klen = static_cast <long> (kw.length());
+      key = new char32_t[klen];
+      std::copy(kw.begin(), kw.end(), key);
 
-      if (wxStrlen(cp))
+      if (!cp.empty())
       {
-         cplen = wxStrlen(cp);
-         char_pattern = new wxChar[cplen];
-         std::copy(cp, cp + cplen, char_pattern);
-      }
+         cplen = static_cast <int> (cp.length());
 
-      sklen = std::numeric_limits<Ty>::max() * 2;
-      skip = new char[sklen];
+         // shared with every equivalency table of the matches
+         charset = std::make_shared <const typename equivalency_type::charset_type> (cp.begin(), cp.end());
+      }
 
       preprocess();
    }
 
    /**
    * Performs a boyer-moore based relative search.
-   * @param data byte array to search on
+   * @param data values to search on (a pointer or a lane_view)
    * @param hlen data length
-   * @return The relative values found.
+   * @param from first position tried
+   * @param to positions from here on are left for the next call
+   * @param results where the relative values found are appended to
+   * @param compared incremented by the number of positions compared
+   * @return The position the search stopped at, where the next call resumes it.
    */
-   std::vector <relative_type> monkey_moore (const Ty *data, long hlen)
+   template <class View> long monkey_moore (const View &data, long hlen, long from, long to, std::vector <relative_type> &results, uint64_t &compared)
    {
-      std::vector <relative_type> results;
-
-      const Ty *hpos_end = data + klen;
-      const Ty *hpos_start = data;
+      uint64_t n = 0;
+      long pos = from;
 
-      int *tmp_tbl = new int[klen];
-
-      while (hpos_end <= data + hlen)
+      for (; pos < to && pos + klen <= hlen; n++)
       {
-         // builds the current block table
-         calc_reltable(hpos_start, tmp_tbl, klen);
+         // compares the relative tables back to front. the differences are computed
+         // as they are compared, so a mismatch costs only what was looked at.
+         // the first one (wrapping around) always matches when all the others do.
+         long i = klen - 1;
+         int elem = 0;
 
-         // compares the relative tables
-         int hits = 0;
-         for (; hits < klen && tmp_tbl[klen - hits - 1] == key_tbl[klen - hits - 1]; hits++);
+         for (; i > 0 && (elem = data[pos + i] - data[pos + i - 1]) == key_tbl[i]; i--);
 
          // we got a match
-         if (hits == klen)
+         if (!i)
          {
-            equivalency_type eq;
-
-            if (type != value_scan)
-            {
-               // for value scan, we're only interested in the offset, not the values
-
-               if (!cplen)
-               {
-                  int dist = *hpos_start - key[0];
-
-                  eq[wxT('A')] = static_cast <Ty> (wxT('A') + dist);
-                  eq[wxT('a')] = static_cast <Ty> (wxT('a') + dist);
-               }
-               else
-               {
-                  int base_diff = *hpos_start - cp_pos[key[0]];
-
-                  for (int i = 0; i < cplen; i++)
-                     eq[char_pattern[i]] = static_cast <Ty> (cp_pos[char_pattern[i]] + base_diff);
-               }
-            }
-
-            results.push_back(make_pair(static_cast <long> (std::distance(data, hpos_start)), eq));
-
-            hpos_end += klen - 1;
-            hpos_start += klen - 1;
+            results.push_back(std::make_pair(pos, make_equivalency(data + pos)));
+            pos += klen - 1;
          }
          else
          {
-            // key didn't fully match, so we must figure out how many bytes to jump over
-
-            int &elem = tmp_tbl[klen - hits - 1];
-            int jump = std::max<char>(skip[elem > 0 ? (sklen / 2) + elem : -elem], 1);
-
-            hpos_end += jump;
-            hpos_start += jump;
+            // key didn't fully match, so we must figure out how many bytes to jump over.
+            // the jump table is laid out for mismatches on the last position, so when it
+            // happens further to the left, the jump is shortened by the matched length.
+            pos += std::max<int>(skip[elem] - (klen - 1 - i), 1);
          }
       }
 
-      delete [] tmp_tbl;
-      return results;
+      compared += n;
+      return pos;
    }
 
-
-
    /**
-   * Performs a boyer-moore based relative search (supporting wildcards).
+   * Performs a relative search on 8-bit data, using a vectorized prefilter
+   * to discard most positions before the full comparison takes place.
    * @param data byte array to search on
    * @param hlen data length
+   * @param scan delta prefilter
+   * @param compared incremented by the number of positions that got past the prefilter
    * @return The relative values found.
    */
-   std::vector <relative_type> monkey_moore_wc (const Ty *data, long hlen)
+   std::vector <relative_type> monkey_moore_simd (const Ty *data, long hlen, delta_scan_type scan, uint64_t &compared)
    {
       std::vector <relative_type> results;
+      uint64_t n = 0;
 
-      const Ty *hpos_end = data + klen;
-      const Ty *hpos_start = data;
-
-      int plen = klen - n_wildcards;
+      const uint8_t *bytes = reinterpret_cast <const uint8_t *> (data);
+      const long last = hlen - klen;
 
-      int *tmp_tbl = new int[klen];
-      int *tmp_tbl_tmp = new int[plen];
-      Ty *tmp_pure = new Ty[plen];
+      // only the first and the last differences of the key are prefiltered
+      const uint8_t first = static_cast <uint8_t> (key_tbl[1]);
+      const uint8_t final = static_cast <uint8_t> (key_tbl[klen - 1]);
 
-      while (hpos_end <= data + hlen)
+      for (long pos = 0; (pos = scan(bytes, pos, last, klen - 2, first, final)) <= last; n++)
       {
-         // calculates the current block's table
-         for (int i=0, j=0; i<klen; i++)
-            if (wc_pos[i]) tmp_pure[j++] = hpos_start[i];
+         // compares the relative tables (back to front, as in the scalar version)
+         long i = klen - 1;
+         for (; i > 0 && static_cast <int> (data[pos + i] - data[pos + i - 1]) == key_tbl[i]; i--);
 
-         calc_reltable(tmp_pure, tmp_tbl_tmp, plen);
+         // we got a match
+         if (!i)
+         {
+            results.push_back(std::make_pair(pos, make_equivalency(data + pos)));
+            pos += klen - 1;
+         }
+         else pos++;
+      }
 
-         for (int i = klen - 1, j = klen - n_wildcards - 1; i >= 0; i--)
-            tmp_tbl[i] = wc_pos[i] ? tmp_tbl_tmp[j--] : 0;
+      compared += n;
+      return results;
+   }
 
-         // compares the relative tables
-         int hits = 0;
-         for (; hits < klen; hits++)
+   /**
+   * Builds the equivalency table of a match found by a simple relative search.
+   * @param match pointer (or lane_view) to the first value of the match
+   * @return The equivalency table (empty for value scan searches).
+   */
+   template <class View> equivalency_type make_equivalency (const View &match)
+   {
+      equivalency_type eq;
+
+      // for value scan, we're only interested in the offset, not the values
+      if (type != value_scan)
+      {
+         if (!cplen)
          {
-            if (mdkey[klen - hits - 1] == card)
-               continue;
-            if (tmp_tbl[klen - hits - 1] != key_tbl[klen - hits - 1])
-               break;
+            int dist = match[0] - key[0];
+            eq = equivalency_type::ascii(static_cast <Ty> (U'A' + dist), static_cast <Ty> (U'a' + dist));
          }
+         else
+            eq = equivalency_type::charset(charset, static_cast <Ty> (match[0] - cp_pos[key[0]]));
+      }
 
-         // we got a match
-         if (hits == klen)
-         {
-            equivalency_type eq;
+      return eq;
+   }
 
-            int index = 0;
-            for (; !wc_pos[index]; index++);
+   /**
+   * Performs a boyer-moore based relative search (supporting wildcards).
+   * @param data values to search on (a pointer or a lane_view)
+   * @param hlen data length
+   * @param from first position tried
+   * @param to positions from here on are left for the next call
+   * @param results where the relative values found are appended to
+   * @param compared incremented by the number of positions compared
+   * @return The position the search stopped at, where the next call resumes it.
+   */
+   template <class View> long monkey_moore_wc (const View &data, long hlen, long from, long to, std::vector <relative_type> &results, uint64_t &compared)
+   {
+      uint64_t n = 0;
+      long pos = from;
 
-            // handles ascii values
-            if (!cplen)
-            {
-               int diff = *(hpos_start + index) - mdkey[index];
-
-               // if the key contains the same capitalization, then we guess the value
-               // of the opposite character (ie: if key is "world", we must guess the value of A)
-               if (!case_change)
-               {
-                  eq[wxT('A')] = static_cast <Ty> (wxT('A') + diff);
-                  eq[wxT('a')] = static_cast <Ty> (wxT('a') + diff);
-               }
-               else
-               {
-                  // if the key contains any capitalization changes, we need to
-                  // find the correct value of the less frequent case.
-
-                  int pos = 0;
-                  for (; lower ? !is_upper(key[pos]) : !is_lower(key[pos]); pos++);
-                  int diff2 = *(hpos_start + pos) - key[pos];
-
-                  eq[wxT('A')] = lower ? static_cast <Ty> (wxT('A') + diff2) : static_cast <Ty> (wxT('A') + diff);
-                  eq[wxT('a')] = lower ? static_cast <Ty> (wxT('a') + diff) : static_cast <Ty> (wxT('a') + diff2);
-               }
-            }
-            else
-            {
-               int base_diff = *(hpos_start + index) - cp_pos[key[index]];
+      const int lead = count_begin(mdkey, mdkey + klen, card);
 
-               for (int i = 0; i < cplen; i++)
-                  eq[char_pattern[i]] = static_cast <Ty> (cp_pos[char_pattern[i]] + base_diff);
-            }
+      for (; pos < to && pos + klen <= hlen; n++)
+      {
+         // compares the relative tables back to front, going from one non-wildcard
+         // position to the previous one and computing only the differences we look at
+         long i = last_pos;
+         int elem = 0;
 
-            results.push_back(std::make_pair(static_cast <long> (std::distance(data, hpos_start)), eq));
+         for (; prev_pos[i] >= 0 && (elem = data[pos + i] - data[pos + prev_pos[i]]) == key_tbl[i]; i = prev_pos[i]);
 
-            int nw = count_begin(mdkey, mdkey + klen, card);
-            hpos_end += klen - 1 - nw;
-            hpos_start += klen - 1 - nw;
+         // we got a match
+         if (prev_pos[i] < 0)
+         {
+            results.push_back(std::make_pair(pos, make_equivalency_wc(data + pos)));
+            pos += klen - 1 - lead;
          }
          else
          {
             // key didn't fully match, so we must figure out how many bytes to jump over
+            int jump = std::max<int>(skip[elem] - (klen - 1 - i), 1);
+            pos += std::min(cards[i], jump);
+         }
+      }
 
-            int &elem = tmp_tbl[klen - hits - 1];
-            int jump = std::min<u8>(cards[klen - hits - 1], std::max<char>(skip[elem > 0 ? (sklen / 2) + elem : -elem], 1));
+      compared += n;
+      return pos;
+   }
+
+   /**
+   * Builds the equivalency table of a match found by a wildcard relative search.
+   * @param match pointer (or lane_view) to the first value of the match
+   * @return The equivalency table.
+   */
+   template <class View> equivalency_type make_equivalency_wc (const View &match)
+   {
+      equivalency_type eq;
 
-            hpos_end += jump;
-            hpos_start += jump;
+      int index = 0;
+      for (; !wc_pos[index]; index++);
+
+      // handles ascii values
+      if (!cplen)
+      {
+         int diff = match[index] - mdkey[index];
+
+         // if the key contains the same capitalization, then we guess the value
+         // of the opposite character (ie: if key is "world", we must guess the value of A)
+         if (!case_change)
+            eq = equivalency_type::ascii(static_cast <Ty> (U'A' + diff), static_cast <Ty> (U'a' + diff));
+         else
+         {
+            // if the key contains any capitalization changes, we need to
+            // find the correct value of the less frequent case.
+
+            int pos = 0;
+            for (; lower ? !is_upper(key[pos]) : !is_lower(key[pos]); pos++);
+            int diff2 = match[pos] - key[pos];
+
+            eq = equivalency_type::ascii(
+               lower ? static_cast <Ty> (U'A' + diff2) : static_cast <Ty> (U'A' + diff),
+               lower ? static_cast <Ty> (U'a' + diff) : static_cast <Ty> (U'a' + diff2));
          }
       }
+      else
+         eq = equivalency_type::charset(charset, static_cast <Ty> (match[index] - cp_pos[key[index]]));
 
-      delete [] tmp_tbl_tmp;
-      delete [] tmp_tbl;
-      delete [] tmp_pure;
-
-      return results;
+      return eq;
    }
 
    /**
@@ -465,7 +639,7 @@ private:
    * @param tbl output table
    * @param size source length
    */
-   void calc_reltable_cp (const wxChar *src, int *tbl, int size)
+   void calc_reltable_cp (const char32_t *src, int *tbl, int size) const
    {
       tbl[0] = cp_pos[src[0]] - cp_pos[src[size - 1]];
 
@@ -475,33 +649,34 @@ private:
 
    // general attributes
 
-   wxChar *key;        /**< search key            */
+   char32_t *key;        /**< search key            */
    long klen;          /**< key length            */
    int *key_tbl;       /**< key's relative table  */
-   char *skip;         /**< jump table            */
-   long sklen;         /**< skip table lenght     */
+   skip_table <Ty> skip;  /**< jump table         */
 
    enum { none, simple_relative, wildcard_relative, value_scan } type;
 
    // wildcard search attributes
 
-   wxChar *mdkey;      /**< modified key (ie: MonkeyMoore -> *onkey*oore) */
-   u8 *cards;          /**< wildcards jump table */ // <-- check this!
+   char32_t *mdkey;      /**< modified key (ie: MonkeyMoore -> *onkey*oore) */
+   int *cards;         /**< wildcards jump table */
    bool *wc_pos;       /**< wildcard map */
+   int *prev_pos;      /**< previous non-wildcard position (-1 on the first one) */
+   int last_pos;       /**< last non-wildcard position */
 
    bool case_change;   /**< indicates change in key's capitalization */
    bool lower;         /**< there are more lower characters then upper? */
    int n_wildcards;    /**< how many wildcards in key */
 
-   const wxChar card;  /**< wildcard character (0 means no wildcard) */
+   const char32_t card;  /**< wildcard character (0 means no wildcard) */
 
    // special attributes
 
    bool custom_charpattern;
-   wxChar *char_pattern;
+   std::shared_ptr <const typename equivalency_type::charset_type> charset;
    int cplen;
 
-   std::map <wxChar, int> cp_pos;
+   charset_index cp_pos;  /**< position of each character in the pattern */
 };
 
 #endif //~MONKEY_MOORE_HPP
@@ -0,0 +1,453 @@
+/*
+ * Monkey-Moore - A simple and powerful relative search tool
+ * Copyright (C) 2007 Ricardo J. Ricken (Darkl0rd)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef MONKEY_MULTI_HPP
+#define MONKEY_MULTI_HPP
+
+#include "monkey_moore.hpp"
+
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <algorithm>
+#include <vector>
+#include <limits>
+
+/**
+* Searches for several keywords at once.
+*
+* A relative match only depends on the differences between adjacent values, so
+* each keyword is turned into its string of differences, and a single automaton
+* (Aho-Corasick) is built over all of them. The data differences are then fed to
+* it in one pass, no matter how many keywords there are. Keywords that can't be
+* matched by their differences alone (wildcards, capitalization changes) are
+* searched on their own, as is a lone keyword, which is faster with Boyer-Moore.
+*/
+template <class Ty> class MonkeyMooreMulti
+{
+public:
+   typedef typename MonkeyMoore<Ty>::equivalency_type equivalency_type;
+   typedef std::tuple <long, int, equivalency_type> relative_type;  /**< offset, keyword index, table */
+
+   /**
+   * Relative search constructor. Builds the automaton over the given keywords.
+   * @param keywords search keys
+   * @param wildcard user defined wildcard
+   * @param pattern custom character set
+   */
+   MonkeyMooreMulti (const std::vector <std::u32string> &keywords, char32_t wildcard = 0, std::u32string_view pattern = std::u32string_view())
+   {
+      assert(keywords.size() != 0);
+
+      for (auto i = keywords.begin(); i != keywords.end(); ++i)
+         searchers.emplace_back(new MonkeyMoore<Ty>(*i, wildcard, pattern));
+
+      preprocess();
+   }
+
+   /**
+   * Value scan relative constructor.
+   * @param vals values to search for
+   */
+   MonkeyMooreMulti (const std::vector <short> &vals)
+   {
+      searchers.emplace_back(new MonkeyMoore<Ty>(vals));
+      preprocess();
+   }
+
+   /**
+   * Searches for all keywords.
+   * @param data byte array to search on
+   * @param len data length
+   * @param candidates if given, incremented by the number of positions compared against the keywords
+   * @return Search results, ordered by offset and keyword.
+   */
+   std::vector <relative_type> search (const Ty *data, long len, uint64_t *candidates = 0)
+   {
+      std::vector <relative_type> results;
+
+      if (!automaton.empty())
+      {
+         lane_state lane(size());
+         search_automaton(data, 1, len, lane, results);
+
+         // the automaton goes through every position once
+         if (candidates && len > 1)
+            *candidates += len - 1;
+      }
+
+      for (auto i = standalone.begin(); i != standalone.end(); ++i)
+      {
+         auto found = searchers[*i]->search(data, len, candidates);
+
+         for (auto j = found.begin(); j != found.end(); ++j)
+            results.push_back(std::make_tuple(j->first, *i, j->second));
+      }
+
+      sort_results(results);
+      return results;
+   }
+
+   /**
+   * Searches for all keywords on multibyte values starting on any byte, going
+   * through the bytes once for all alignments (see MonkeyMoore::search_lanes).
+   * @param bytes byte array to search on
+   * @param size number of bytes
+   * @param swap whether the bytes of each value are swapped as it's loaded
+   * @param candidates if given, incremented by the number of positions compared against the keywords
+   * @return Search results, with offsets in bytes, ordered by offset and keyword.
+   */
+   std::vector <relative_type> search_lanes (const uint8_t *bytes, long size, bool swap, uint64_t *candidates = 0)
+   {
+      std::vector <relative_type> results[2];
+      search_lanes(bytes, size, swap ? swapped_order : native_order, results, candidates);
+
+      return std::move(results[swap ? 1 : 0]);
+   }
+
+   /**
+   * Searches for all keywords on multibyte values starting on any byte, in one byte
+   * order or both, going through the bytes once (see MonkeyMoore::search_lanes).
+   * @param bytes byte array to search on
+   * @param size number of bytes
+   * @param orders byte orders the values are loaded with (native_order, swapped_order or both_orders)
+   * @param results results of each byte order (the native one first), with offsets in bytes, ordered by offset and keyword
+   * @param candidates if given, incremented by the number of positions compared against the keywords
+   */
+   void search_lanes (const uint8_t *bytes, long size, int orders, std::vector <relative_type> *results, uint64_t *candidates = 0)
+   {
+      results[0].clear();
+      results[1].clear();
+
+      if (!automaton.empty())
+         search_automaton_lanes(bytes, size, orders, results, candidates);
+
+      for (auto i = standalone.begin(); i != standalone.end(); ++i)
+      {
+         std::vector <typename MonkeyMoore<Ty>::relative_type> found[2];
+         searchers[*i]->search_lanes(bytes, size, orders, found, candidates);
+
+         for (int order = 0; order < 2; order++)
+            for (auto j = found[order].begin(); j != found[order].end(); ++j)
+               results[order].push_back(std::make_tuple(j->first, *i, j->second));
+      }
+
+      sort_results(results[0]);
+      sort_results(results[1]);
+   }
+
+   /**
+   * Returns the number of keywords.
+   * @return Number of keywords.
+   */
+   int size () const { return static_cast <int> (searchers.size()); }
+
+   /**
+   * Returns the length of a keyword.
+   * @param index keyword index
+   * @return Number of characters (or values) in the keyword.
+   */
+   long length (int index) const { return searchers[index]->length(); }
+
+private:
+   /**
+   * Automaton state. Transitions are kept sorted by difference.
+   */
+   struct node_type
+   {
+      node_type () : fail(0) { }
+
+      std::vector <std::pair <int, int>> next;  /**< difference -> state */
+      std::vector <int> out;                    /**< keywords ending here */
+      int fail;                                 /**< longest proper suffix state */
+   };
+
+   /**
+   * Where the automaton is at on a lane, kept from one chunk of values to the next.
+   */
+   struct lane_state
+   {
+      lane_state (int keywords) : state(0), next_start(keywords, 0) { }
+
+      int state;                      /**< current state                                */
+      std::vector <long> next_start;  /**< where the next match of each keyword may start */
+   };
+
+   /**
+   * Decides which keywords go into the automaton, and builds it.
+   */
+   void preprocess ()
+   {
+      std::vector <int> indexed;
+
+      for (int i = 0; i < size(); i++)
+      {
+         if (!searchers[i]->is_simple() || searchers[i]->length() < 2)
+            standalone.push_back(i);
+
+         // a keyword with differences the data can't have never matches (ie: "a€" on 8-bit data)
+         else if (fits(*searchers[i]))
+            indexed.push_back(i);
+      }
+
+      // a single keyword is better off with its own jump tables
+      if (indexed.size() < 2)
+      {
+         standalone.insert(standalone.end(), indexed.begin(), indexed.end());
+         std::sort(standalone.begin(), standalone.end());
+         return;
+      }
+
+      // the root keeps a direct table, since most of the data differences land there
+      if (range)
+         root_next.assign(2 * range + 1, -1);
+
+      automaton.resize(1);
+
+      for (auto i = indexed.begin(); i != indexed.end(); ++i)
+      {
+         const MonkeyMoore<Ty> &mm = *searchers[*i];
+         int state = 0;
+
+         for (long pos = 1; pos < mm.length(); pos++)
+         {
+            int next = child(state, mm.difference(pos));
+
+            if (next < 0)
+            {
+               next = static_cast <int> (automaton.size());
+               automaton.push_back(node_type());
+               add_child(state, mm.difference(pos), next);
+            }
+
+            state = next;
+         }
+
+         automaton[state].out.push_back(*i);
+      }
+
+      // --- failure links, breadth first
+      std::vector <int> queue;
+
+      for (auto i = automaton[0].next.begin(); i != automaton[0].next.end(); ++i)
+         queue.push_back(i->second);
+
+      for (size_t head = 0; head < queue.size(); head++)
+      {
+         const int state = queue[head];
+
+         for (auto i = automaton[state].next.begin(); i != automaton[state].next.end(); ++i)
+         {
+            node_type &target = automaton[i->second];
+
+            target.fail = step(automaton[state].fail, i->first);
+
+            // a keyword ending on the suffix ends here as well
+            const std::vector <int> &inherited = automaton[target.fail].out;
+            target.out.insert(target.out.end(), inherited.begin(), inherited.end());
+
+            queue.push_back(i->second);
+         }
+      }
+   }
+
+   /**
+   * Finds out whether every difference of a keyword lies between the ones two values
+   * of the data type can have, as only then it can be matched.
+   * @param mm keyword searcher
+   * @return True if the keyword can be matched.
+   */
+   static bool fits (const MonkeyMoore<Ty> &mm)
+   {
+      const long long limit = std::numeric_limits<Ty>::max();
+
+      for (long pos = 1; pos < mm.length(); pos++)
+         if (mm.difference(pos) > limit || mm.difference(pos) < -limit)
+            return false;
+
+      return true;
+   }
+
+   /**
+   * Feeds the data differences to the automaton.
+   * @param data values to search on (a pointer or a lane_view)
+   * @param from first position fed (at least 1, the difference with the previous value)
+   * @param to end of the positions fed
+   * @param lane automaton state, carried over from the previous positions
+   * @param results where matches are appended to
+   */
+   template <class View> void search_automaton (const View &data, long from, long to, lane_state &lane, std::vector <relative_type> &results)
+   {
+      for (long pos = from; pos < to; pos++)
+      {
+         lane.state = step(lane.state, data[pos] - data[pos - 1]);
+
+         const std::vector <int> &out = automaton[lane.state].out;
+
+         for (auto i = out.begin(); i != out.end(); ++i)
+         {
+            const long start = pos - searchers[*i]->length() + 1;
+
+            // like the single keyword search, a match hides the overlapping ones of the same keyword
+            if (start < lane.next_start[*i])
+               continue;
+
+            lane.next_start[*i] = start + searchers[*i]->length() - 1;
+            results.push_back(std::make_tuple(start, *i, searchers[*i]->equivalency(data + start)));
+         }
+      }
+   }
+
+   /**
+   * Feeds the data differences of every lane to the automaton, a chunk at a time.
+   * @param bytes byte array to search on
+   * @param size number of bytes
+   * @param orders byte orders the values are loaded with
+   * @param results where matches of each byte order are appended to, with offsets in bytes
+   * @param candidates if given, incremented by the number of positions gone through
+   */
+   void search_automaton_lanes (const uint8_t *bytes, long size, int orders, std::vector <relative_type> *results, uint64_t *candidates)
+   {
+      const long lanes = sizeof(Ty);
+      std::vector <lane_state> state[2];
+
+      for (int order = 0; order < 2; order++)
+         state[order].assign(lanes, lane_state(this->size()));
+
+      // the first lane is the longest one
+      for (long start = 1; start < size / lanes; start += lane_chunk)
+      {
+         for (long lane = 0; lane < lanes; lane++)
+         {
+            const long count = (size - lane) / lanes;
+            const long end = std::min(start + lane_chunk, count);
+
+            for (int order = 0; order < 2; order++)
+            {
+               if (!(orders & (order ? swapped_order : native_order)))
+                  continue;
+
+               const size_t first = results[order].size();
+
+               if (order)
+                  search_automaton(lane_view <Ty, true> (bytes + lane), start, end, state[order][lane], results[order]);
+               else
+                  search_automaton(lane_view <Ty, false> (bytes + lane), start, end, state[order][lane], results[order]);
+
+               for (size_t i = first; i < results[order].size(); i++)
+                  std::get<0>(results[order][i]) = lane + std::get<0>(results[order][i]) * lanes;
+            }
+         }
+      }
+
+      // the automaton goes through every position once, in each byte order
+      const int passes = orders == both_orders ? 2 : 1;
+
+      for (long lane = 0; candidates && lane < lanes && size - lane > lanes; lane++)
+         *candidates += passes * ((size - lane) / lanes - 1);
+   }
+
+   /**
+   * Orders the results by offset and keyword.
+   * @param results search results
+   */
+   void sort_results (std::vector <relative_type> &results) const
+   {
+      // the automaton reports matches by where they end, and each
+      // keyword searched on its own comes with its own ordered results
+      if (size() > 1)
+      {
+         std::sort(results.begin(), results.end(), [] (const relative_type &a, const relative_type &b) {
+            return std::get<0>(a) != std::get<0>(b) ? std::get<0>(a) < std::get<0>(b) : std::get<1>(a) < std::get<1>(b);
+         });
+      }
+   }
+
+   /**
+   * Follows a transition, falling back on the failure links when it doesn't exist.
+   * @param state current state
+   * @param diff relative difference
+   * @return The next state.
+   */
+   int step (int state, int diff) const
+   {
+      for (;;)
+      {
+         const int next = child(state, diff);
+
+         if (next >= 0)
+            return next;
+
+         if (!state)
+            return 0;
+
+         state = automaton[state].fail;
+      }
+   }
+
+   /**
+   * Looks for a transition of the given state.
+   * @param state current state
+   * @param diff relative difference
+   * @return The next state, or -1 if there's no such transition.
+   */
+   int child (int state, int diff) const
+   {
+      if (!state && range)
+      {
+         assert(diff >= -range && diff <= range);
+         return root_next[diff + range];
+      }
+
+      const std::vector <std::pair <int, int>> &next = automaton[state].next;
+      auto i = std::lower_bound(next.begin(), next.end(), std::make_pair(diff, std::numeric_limits<int>::min()));
+
+      return i != next.end() && i->first == diff ? i->second : -1;
+   }
+
+   /**
+   * Adds a transition to the given state.
+   * @param state source state
+   * @param diff relative difference
+   * @param next target state
+   */
+   void add_child (int state, int diff, int next)
+   {
+      if (!state && range)
+      {
+         assert(diff >= -range && diff <= range);
+         root_next[diff + range] = next;
+      }
+
+      std::vector <std::pair <int, int>> &edges = automaton[state].next;
+      edges.insert(std::lower_bound(edges.begin(), edges.end(), std::make_pair(diff, next)), std::make_pair(diff, next));
+   }
+
+   /** differences between two values lie in the [-range, range] interval. it's 0 when
+   that's too wide for the root table to stay cached (16 and 32-bit data), which then
+   looks its transitions up like the others. */
+   static const int range = sizeof(Ty) == 1 ? static_cast <int> (std::numeric_limits<Ty>::max()) : 0;
+
+   std::vector <std::unique_ptr <MonkeyMoore<Ty>>> searchers;  /**< one per keyword      */
+   std::vector <int> standalone;                               /**< searched on their own */
+
+   std::vector <node_type> automaton;  /**< automaton states (0 is the root) */
+   std::vector <int> root_next;        /**< root transitions, by difference  */
+};
+
+#endif //~MONKEY_MULTI_HPP
@@ -32,7 +32,6 @@
 #include "constants.hpp"
 #include "monkey_prefs.hpp"
 
-#include <thread>
 #include <wx/spinctrl.h>
 
 /**
@@ -96,7 +95,6 @@ public:
       smt_sz->Add(smt_units, wxSizerFlags().Left().Border(wxTOP, 5));
 
       smt_numthreads->SetRange(1, 16);
-      smt_numthreads->SetValue(std::min<uint16_t>(std::thread::hardware_concurrency(), 16));
 
       wxStaticBoxSizer *perf_sz = new wxStaticBoxSizer(new wxStaticBox(this, wxID_ANY, _("Performance")), wxVERTICAL);
       perf_sz->Add(searchbuf_sz, wxSizerFlags().Border(wxLEFT, 2));
@@ -130,6 +128,7 @@ public:
       prefs.getBool(wxT("settings/display-offset-mode"), wxT("hex")) ? off_hex->SetValue(true) : off_dec->SetValue(true);
 
       sb_size->SetValue(wxString::Format(wxT("%d"), prefs.getInt(wxT("settings/perf-memory-pool")) / 1048576));
+      smt_numthreads->SetValue(prefs.getInt(wxT("settings/perf-search-threads")));
    }
 
    ~MonkeyOptions () {
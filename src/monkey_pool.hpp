@@ -0,0 +1,186 @@
+/*
+ * Monkey-Moore - A simple and powerful relative search tool
+ * Copyright (C) 2007 Ricardo J. Ricken (Darkl0rd)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef MONKEY_POOL_HPP
+#define MONKEY_POOL_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+* Fixed set of worker threads fed by a bounded job queue.
+* Submitting blocks while the queue is full, so whoever produces the jobs
+* (ie: the thread reading the file) can't get too far ahead of the workers.
+*/
+class WorkerPool
+{
+public:
+   typedef std::function<void ()> job_type;
+
+   /**
+   * Constructor. Spawns the worker threads, which live until the pool is destroyed.
+   * @param numThreads number of workers (0 means one per hardware thread)
+   * @param maxQueued how many jobs may be waiting for a free worker
+   */
+   WorkerPool (unsigned int numThreads, size_t maxQueued) :
+   m_maxQueued(std::max<size_t>(maxQueued, 1)), m_pending(0), m_stop(false)
+   {
+      if (!numThreads)
+         numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+      for (unsigned int i = 0; i < numThreads; ++i)
+         m_workers.emplace_back(&WorkerPool::Run, this, i);
+   }
+
+   /**
+   * Destructor. Lets the workers finish the queued jobs and joins them.
+   */
+   ~WorkerPool ()
+   {
+      {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         m_stop = true;
+      }
+
+      m_jobAvailable.notify_all();
+
+      for (auto i = m_workers.begin(); i != m_workers.end(); ++i)
+         i->join();
+   }
+
+   /**
+   * Queues a job, blocking the caller while the queue is full.
+   * @param job the job to be run by one of the workers
+   */
+   void Submit (job_type job)
+   {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_slotAvailable.wait(lock, [this] { return m_jobs.size() < m_maxQueued; });
+
+      m_jobs.push_back(std::move(job));
+      ++m_pending;
+
+      m_jobAvailable.notify_one();
+   }
+
+   /**
+   * Drops every job that wasn't picked up by a worker yet.
+   * Jobs already running are not interrupted.
+   */
+   void Cancel ()
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      m_pending -= m_jobs.size();
+      m_jobs.clear();
+
+      m_slotAvailable.notify_all();
+
+      if (!m_pending)
+         m_idle.notify_all();
+   }
+
+   /**
+   * Blocks until every submitted job has finished running.
+   */
+   void Wait ()
+   {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_idle.wait(lock, [this] { return m_pending == 0; });
+   }
+
+   /**
+   * Returns the number of worker threads.
+   * @return Number of workers.
+   */
+   size_t GetSize () const { return m_workers.size(); }
+
+   /**
+   * Finds out which worker is running the calling thread (ie: from inside a job).
+   * @return Worker index, in the [0, GetSize()) range, or -1 when not called by a worker.
+   */
+   static size_t GetCurrentWorker () { return CurrentWorker(); }
+
+private:
+   /**
+   * Index of the worker running on this thread.
+   * @return Reference to the thread's own index.
+   */
+   static size_t &CurrentWorker ()
+   {
+      static thread_local size_t index = static_cast<size_t>(-1);
+      return index;
+   }
+
+   /**
+   * Worker thread loop. Takes jobs from the queue until the pool is stopped.
+   * @param index worker index
+   */
+   void Run (size_t index)
+   {
+      CurrentWorker() = index;
+
+      while (true)
+      {
+         job_type job;
+
+         {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobAvailable.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+
+            if (m_jobs.empty())
+               return;
+
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+
+            m_slotAvailable.notify_one();
+         }
+
+         job();
+
+         // whatever the job holds (ie: its buffers) is released before it counts as done
+         job = nullptr;
+
+         {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (!--m_pending)
+               m_idle.notify_all();
+         }
+      }
+   }
+
+   std::vector<std::thread> m_workers;       /**< worker threads                 */
+   std::deque<job_type> m_jobs;              /**< jobs waiting for a worker      */
+   const size_t m_maxQueued;                 /**< max jobs waiting in the queue  */
+   size_t m_pending;                         /**< jobs queued or running         */
+   bool m_stop;                              /**< workers must quit when idle    */
+
+   std::mutex m_mutex;                       /**< guards all of the above        */
+   std::condition_variable m_jobAvailable;   /**< signaled when a job is queued  */
+   std::condition_variable m_slotAvailable;  /**< signaled when a job is taken   */
+   std::condition_variable m_idle;           /**< signaled when nothing's left   */
+};
+
+#endif //~MONKEY_POOL_HPP
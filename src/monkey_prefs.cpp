@@ -27,6 +27,8 @@
 #include <vector>
 #include <exception>
 #include <regex>
+#include <thread>
+#include <algorithm>
 
 using namespace std;
 
@@ -42,7 +44,7 @@ void MonkeyPrefs::setDefaultValues ()
    values[wxT("settings/display-preview-width")] = wxT("50");
    values[wxT("settings/display-offset-mode")]   = wxT("hex");
    values[wxT("settings/perf-memory-pool")]      = wxT("8388608");
-   values[wxT("settings/perf-search-threads")]   = wxT("4");
+   values[wxT("settings/perf-search-threads")]   = wxString::Format(wxT("%u"), min(max(thread::hardware_concurrency(), 1u), 16u));
 
    values[wxT("window/position-x")]              = wxT("0");
    values[wxT("window/position-y")]              = wxT("0");
@@ -0,0 +1,101 @@
+/*
+ * Monkey-Moore - A simple and powerful relative search tool
+ * Copyright (C) 2007 Ricardo J. Ricken (Darkl0rd)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef MONKEY_RESULTS_HPP
+#define MONKEY_RESULTS_HPP
+
+#include <wx/wxprec.h>
+
+#ifdef __BORLANDC__
+#pragma hdrstop
+#endif
+
+#ifndef WX_PRECOMP
+#include <wx/wx.h>
+#endif
+
+#include <wx/listctrl.h>
+#include <functional>
+
+/**
+* Virtual list showing the search results. Rows aren't stored in the control: their
+* text is only generated when they become visible, so listing millions of results
+* costs no more than listing a few.
+*/
+class MonkeyResultList : public wxListCtrl
+{
+public:
+   typedef std::function<wxString (long item, long column)> text_source;
+   typedef std::function<uint32_t (long item)> index_source;
+
+   MonkeyResultList (wxWindow *parent, wxWindowID id) :
+   wxListCtrl(parent, id, wxDefaultPosition, wxDefaultSize, wxLC_REPORT | wxLC_SINGLE_SEL | wxLC_VIRTUAL) { }
+
+   /**
+   * Sets what is shown in the list.
+   * @param count number of rows
+   * @param text generates the text of a cell
+   * @param index finds out which result is shown on a row
+   */
+   void SetSource (long count, text_source text, index_source index)
+   {
+      m_text = text;
+      m_index = index;
+
+      SetItemCount(count);
+      Refresh();
+   }
+
+   /**
+   * Empties the list.
+   */
+   void Reset ()
+   {
+      DeleteAllItems();
+
+      m_text = text_source();
+      m_index = index_source();
+   }
+
+   /**
+   * Finds out which result is shown on a row.
+   * @param item row
+   * @return Index of the result.
+   */
+   uint32_t GetResultIndex (long item) const { return m_index(item); }
+
+   /**
+   * Gets the text of a cell.
+   * @param item row
+   * @param column column
+   * @return Text shown on the cell.
+   */
+   wxString GetCellText (long item, long column) const { return OnGetItemText(item, column); }
+
+protected:
+   virtual wxString OnGetItemText (long item, long column) const
+   {
+      return m_text ? m_text(item, column) : wxString();
+   }
+
+private:
+   text_source m_text;    /**< generates the text of each cell  */
+   index_source m_index;  /**< maps rows to results             */
+};
+
+#endif //~MONKEY_RESULTS_HPP
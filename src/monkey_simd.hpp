@@ -0,0 +1,207 @@
+/*
+ * Monkey-Moore - A simple and powerful relative search tool
+ * Copyright (C) 2007 Ricardo J. Ricken (Darkl0rd)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef MONKEY_SIMD_HPP
+#define MONKEY_SIMD_HPP
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+   #define MM_SIMD_X86
+   #include <immintrin.h>
+
+   #ifdef _MSC_VER
+      #include <intrin.h>
+   #endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+   #define MM_TARGET(isa) __attribute__((target(isa)))
+#else
+   #define MM_TARGET(isa)
+#endif
+
+/*
+   Relative searches compare differences between adjacent values, so a cheap way
+   to discard most of the positions in 8-bit data is to check only two of those
+   differences - the first and the last ones of the key - for many positions at
+   once. The byte subtraction wraps around, so the filter accepts a few positions
+   whose real (non-wrapped) differences don't match, but never rejects a match.
+   Whatever passes the filter must be verified by the caller.
+*/
+
+/**
+* Signature of a delta prefilter scanning function.
+* @param data byte array to search on
+* @param pos first candidate position
+* @param last last candidate position (inclusive)
+* @param gap distance between the first and the last checked differences
+* @param first expected value of data[i + 1] - data[i]
+* @param final expected value of data[i + gap + 1] - data[i + gap]
+* @return The first candidate position not rejected, or last + 1 if there's none.
+*/
+typedef long (*delta_scan_type) (const uint8_t *data, long pos, long last, long gap, uint8_t first, uint8_t final);
+
+/**
+* Portable version of the delta prefilter, used on the tail of the data
+* and on processors lacking the instructions needed by the others.
+*/
+inline long delta_scan_scalar (const uint8_t *data, long pos, long last, long gap, uint8_t first, uint8_t final)
+{
+   for (; pos <= last; ++pos)
+   {
+      if (static_cast<uint8_t>(data[pos + 1] - data[pos]) == first &&
+          static_cast<uint8_t>(data[pos + gap + 1] - data[pos + gap]) == final)
+         return pos;
+   }
+
+   return pos;
+}
+
+#ifdef MM_SIMD_X86
+
+/**
+* Returns the index of the lowest set bit.
+* @param mask a non-zero value
+* @return Index of the bit.
+*/
+inline int lowest_bit (uint32_t mask)
+{
+#ifdef _MSC_VER
+   unsigned long index;
+   _BitScanForward(&index, mask);
+   return static_cast<int>(index);
+#else
+   return __builtin_ctz(mask);
+#endif
+}
+
+/**
+* SSE2 version of the delta prefilter, 16 positions per iteration.
+*/
+MM_TARGET("sse2")
+inline long delta_scan_sse2 (const uint8_t *data, long pos, long last, long gap, uint8_t first, uint8_t final)
+{
+   const __m128i vfirst = _mm_set1_epi8(static_cast<char>(first));
+   const __m128i vfinal = _mm_set1_epi8(static_cast<char>(final));
+
+   for (; pos + 15 <= last; pos += 16)
+   {
+      const uint8_t *p = data + pos;
+
+      __m128i d0 = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 1)),
+                                _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+      __m128i d1 = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + gap + 1)),
+                                _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + gap)));
+
+      uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(
+         _mm_and_si128(_mm_cmpeq_epi8(d0, vfirst), _mm_cmpeq_epi8(d1, vfinal))));
+
+      if (mask)
+         return pos + lowest_bit(mask);
+   }
+
+   return delta_scan_scalar(data, pos, last, gap, first, final);
+}
+
+/**
+* AVX2 version of the delta prefilter, 32 positions per iteration.
+*/
+MM_TARGET("avx2")
+inline long delta_scan_avx2 (const uint8_t *data, long pos, long last, long gap, uint8_t first, uint8_t final)
+{
+   const __m256i vfirst = _mm256_set1_epi8(static_cast<char>(first));
+   const __m256i vfinal = _mm256_set1_epi8(static_cast<char>(final));
+
+   for (; pos + 31 <= last; pos += 32)
+   {
+      const uint8_t *p = data + pos;
+
+      __m256i d0 = _mm256_sub_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 1)),
+                                   _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)));
+      __m256i d1 = _mm256_sub_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + gap + 1)),
+                                   _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + gap)));
+
+      uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+         _mm256_and_si256(_mm256_cmpeq_epi8(d0, vfirst), _mm256_cmpeq_epi8(d1, vfinal))));
+
+      if (mask)
+         return pos + lowest_bit(mask);
+   }
+
+   return delta_scan_sse2(data, pos, last, gap, first, final);
+}
+
+/**
+* Checks which instruction sets are supported by both the processor and the OS.
+* @param avx2 set to true when AVX2 can be used
+* @param sse2 set to true when SSE2 can be used
+*/
+inline void detect_simd_support (bool &avx2, bool &sse2)
+{
+#ifdef _MSC_VER
+   int info[4];
+   __cpuid(info, 0);
+   const int maxLeaf = info[0];
+
+   __cpuid(info, 1);
+   sse2 = (info[3] & (1 << 26)) != 0;
+
+   // AVX2 also needs the OS to preserve the YMM registers (OSXSAVE + XCR0)
+   bool osxsave = (info[2] & (1 << 27)) != 0;
+   bool ymm = osxsave && (_xgetbv(0) & 6) == 6;
+
+   avx2 = false;
+
+   if (ymm && maxLeaf >= 7)
+   {
+      __cpuidex(info, 7, 0);
+      avx2 = (info[1] & (1 << 5)) != 0;
+   }
+#else
+   __builtin_cpu_init();
+   sse2 = __builtin_cpu_supports("sse2") != 0;
+   avx2 = __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif //~MM_SIMD_X86
+
+/**
+* Picks the fastest delta prefilter supported by the running processor.
+* The check is done only once, the first time this function is called.
+* @return Pointer to the chosen scanning function.
+*/
+inline delta_scan_type select_delta_scan ()
+{
+#ifdef MM_SIMD_X86
+   static const delta_scan_type best = [] () -> delta_scan_type
+   {
+      bool avx2, sse2;
+      detect_simd_support(avx2, sse2);
+
+      return avx2 ? delta_scan_avx2 : sse2 ? delta_scan_sse2 : delta_scan_scalar;
+   }();
+
+   return best;
+#else
+   return delta_scan_scalar;
+#endif
+}
+
+#endif //~MONKEY_SIMD_HPP
@@ -0,0 +1,154 @@
+/*
+ * Monkey-Moore - A simple and powerful relative search tool
+ * Copyright (C) 2007 Ricardo J. Ricken (Darkl0rd)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef MONKEY_SKIP_HPP
+#define MONKEY_SKIP_HPP
+
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/**
+* Boyer-Moore jump table, indexed by the relative difference found on a mismatch.
+* Each difference maps to how far the key can be moved, and the ones not in the
+* key get the default jump.
+*
+* 8-bit data gets a direct table with room for every possible difference: negative
+* ones are mapped on positions 0-255, and positive ones on 257-511. That doesn't
+* scale to wider types (128 KB on 16-bit data, 8 GB on 32-bit data), while the key
+* holds just a handful of differences, so they get a small open addressing hash
+* table instead, which stays in the L1 cache during the whole search.
+* @tparam Ty data type being searched
+* @tparam Direct true for the direct table
+*/
+template <class Ty, bool Direct = (sizeof(Ty) == 1)> class skip_table;
+
+template <class Ty> class skip_table <Ty, true>
+{
+public:
+   /**
+   * Clears the table.
+   * @param klen key length (the default jump is one less)
+   */
+   void reset (long klen)
+   {
+      fallback = static_cast <char> (klen - 1);
+      jumps.assign(2 * (static_cast <size_t> (std::numeric_limits<Ty>::max()) + 1), fallback);
+   }
+
+   /**
+   * Sets the jump of a difference, unless it was already set. Differences two values
+   * can't have (ie: from keys with wider characters) are never looked up, so they're left out.
+   * @param diff relative difference
+   * @param jump how far the key can be moved (less than the default)
+   */
+   void insert (int diff, int jump)
+   {
+      if (diff > static_cast <int> (std::numeric_limits<Ty>::max()) || diff < -static_cast <int> (std::numeric_limits<Ty>::max()))
+         return;
+
+      const size_t i = index(diff);
+
+      if (jumps[i] == fallback)
+         jumps[i] = static_cast <char> (jump);
+   }
+
+   /**
+   * Looks up the jump of a difference.
+   * @param diff relative difference
+   * @return How far the key can be moved.
+   */
+   int operator[] (int diff) const { return jumps[index(diff)]; }
+
+private:
+   size_t index (int diff) const
+   {
+      return diff > 0 ? jumps.size() / 2 + diff : -diff;
+   }
+
+   std::vector <char> jumps;  /**< jump of every difference */
+   char fallback;             /**< default jump             */
+};
+
+template <class Ty> class skip_table <Ty, false>
+{
+public:
+   /**
+   * Clears the table.
+   * @param klen key length (the default jump is one less)
+   */
+   void reset (long klen)
+   {
+      fallback = static_cast <int> (klen - 1);
+
+      // at most klen differences go in, so keep it no more than half full
+      for (bits = 4; (1L << bits) < 2 * klen; bits++);
+
+      slots.assign(size_t(1) << bits, slot_type(0, 0));
+   }
+
+   /**
+   * Sets the jump of a difference, unless it was already set.
+   * @param diff relative difference
+   * @param jump how far the key can be moved (positive, less than the default)
+   */
+   void insert (int diff, int jump)
+   {
+      slot_type &slot = slots[find(diff)];
+
+      if (!slot.second)
+         slot = slot_type(diff, jump);
+   }
+
+   /**
+   * Looks up the jump of a difference.
+   * @param diff relative difference
+   * @return How far the key can be moved.
+   */
+   int operator[] (int diff) const
+   {
+      const slot_type &slot = slots[find(diff)];
+      return slot.second ? slot.second : fallback;
+   }
+
+private:
+   /**
+   * Finds the slot of a difference, or the free slot where it would go.
+   * @param diff relative difference
+   * @return Slot index.
+   */
+   size_t find (int diff) const
+   {
+      const size_t mask = slots.size() - 1;
+      size_t i = (static_cast <uint32_t> (diff) * 2654435769u) >> (32 - bits);
+
+      for (; slots[i].second && slots[i].first != diff; i = (i + 1) & mask);
+
+      return i;
+   }
+
+   typedef std::pair <int, int> slot_type;  /**< difference, jump (0 marks a free slot) */
+
+   std::vector <slot_type> slots;  /**< hash table                 */
+   int fallback;                   /**< default jump               */
+   int bits;                       /**< log2 of the number of slots */
+};
+
+#endif //~MONKEY_SKIP_HPP
@@ -0,0 +1,320 @@
+/*
+ * Monkey-Moore - A simple and powerful relative search tool
+ * Copyright (C) 2007 Ricardo J. Ricken (Darkl0rd)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef MONKEY_STATS_HPP
+#define MONKEY_STATS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+* Timing and throughput counters of a search, kept per block and per worker.
+*
+* Blocks go through the same phases: they're read by the thread walking the file
+* (mapped files are only read when searched, as page faults, so that time shows up
+* as search time instead), then searched (multibyte values are byte swapped as
+* they're loaded), merged into the results, sorted and previewed by a worker.
+* Workers waiting for blocks (queue wait) point to a disk-bound search; the reader
+* waiting for a free slot in the queue (submit wait) points to a CPU-bound one.
+*/
+class SearchStats
+{
+public:
+   typedef std::chrono::steady_clock clock_type;
+
+   enum Phase { read, search, merge, sort, preview, queueWait, submitWait, numPhases };
+
+   /**
+   * Counters of a block, or summed over several of them.
+   */
+   struct Counters
+   {
+      Counters () : blocks(0), bytes(0), candidates(0), results(0)
+      {
+         for (int i = 0; i < numPhases; ++i)
+            seconds[i] = 0;
+      }
+
+      /**
+      * Adds other counters to these.
+      * @param c counters to add
+      */
+      void Add (const Counters &c)
+      {
+         blocks += c.blocks;
+         bytes += c.bytes;
+         candidates += c.candidates;
+         results += c.results;
+
+         for (int i = 0; i < numPhases; ++i)
+            seconds[i] += c.seconds[i];
+      }
+
+      /**
+      * Returns the time spent on the phases done by the workers, waits not included.
+      * @return Busy time, in seconds.
+      */
+      double GetBusySeconds () const
+      {
+         return seconds[search] + seconds[merge] + seconds[sort] + seconds[preview];
+      }
+
+      uint64_t blocks;       /**< blocks searched                         */
+      uint64_t bytes;        /**< bytes searched (overlaps counted once)  */
+      uint64_t candidates;   /**< positions compared against the keywords */
+      uint64_t results;      /**< results found                           */
+      double seconds[numPhases];  /**< time spent on each phase           */
+   };
+
+   /**
+   * Counters of the whole search so far, as reported with its progress.
+   */
+   struct Summary
+   {
+      Summary () : elapsed(0) { }
+
+      /**
+      * Finds out whether the workers mostly waited for blocks to be read.
+      * @return True if the search is disk-bound, false if it's CPU-bound.
+      */
+      bool IsDiskBound () const { return totals.seconds[queueWait] > totals.GetBusySeconds(); }
+
+      /**
+      * Returns the search throughput.
+      * @return Bytes searched per second of elapsed time.
+      */
+      double GetBytesPerSecond () const { return elapsed > 0 ? totals.bytes / elapsed : 0; }
+
+      Counters totals;                /**< every block, plus the reader       */
+      Counters reader;                /**< thread reading the file            */
+      std::vector<Counters> workers;  /**< each worker                        */
+      double elapsed;                 /**< seconds since the search started   */
+   };
+
+   SearchStats () : m_running(false), m_elapsed(0) { }
+
+   /**
+   * Clears the counters and starts timing a search.
+   * @param numWorkers number of workers searching the blocks
+   */
+   void Start (size_t numWorkers)
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      m_summary = Summary();
+      m_summary.workers.assign(numWorkers, Counters());
+      m_blocks.clear();
+      m_settings.clear();
+
+      m_start = clock_type::now();
+      m_running = true;
+   }
+
+   /**
+   * Stops timing the search.
+   */
+   void Stop ()
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      m_elapsed = Seconds(m_start, clock_type::now());
+      m_running = false;
+   }
+
+   /**
+   * Records a setting the search was run with, listed in the JSON dump.
+   * @param name setting name
+   * @param value setting value
+   */
+   void SetSetting (const std::string &name, uint64_t value)
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_settings.push_back(std::make_pair(name, value));
+   }
+
+   /**
+   * Adds the counters of a searched block.
+   * @param file file index
+   * @param block block index in the file
+   * @param worker index of the worker that searched it
+   * @param c block counters
+   */
+   void AddBlock (size_t file, uint32_t block, size_t worker, const Counters &c)
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      BlockRecord record = { file, block, worker, c };
+      m_blocks.push_back(record);
+
+      m_summary.totals.Add(c);
+
+      if (worker < m_summary.workers.size())
+         m_summary.workers[worker].Add(c);
+   }
+
+   /**
+   * Adds time spent by the thread reading the file. Reads are also in the counters
+   * of the blocks they're for, so they only go in the totals from there.
+   * @param phase read or submitWait
+   * @param seconds time spent
+   */
+   void AddReaderTime (Phase phase, double seconds)
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      m_summary.reader.seconds[phase] += seconds;
+
+      if (phase != read)
+         m_summary.totals.seconds[phase] += seconds;
+   }
+
+   /**
+   * Returns the counters so far.
+   * @return Summary of the search.
+   */
+   Summary GetSummary () const
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      Summary s(m_summary);
+      s.elapsed = m_running ? Seconds(m_start, clock_type::now()) : m_elapsed;
+
+      return s;
+   }
+
+   /**
+   * Dumps every counter, block by block, in JSON.
+   * @return JSON object.
+   */
+   std::string ToJson () const
+   {
+      const Summary s = GetSummary();
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      std::string json = "{\n  \"elapsed_seconds\": " + Number(s.elapsed) +
+         ",\n  \"bytes_per_second\": " + Number(s.GetBytesPerSecond()) +
+         ",\n  \"bound\": \"" + (s.IsDiskBound() ? "disk" : "cpu") + "\",\n  \"settings\": {";
+
+      for (size_t i = 0; i < m_settings.size(); ++i)
+         json += (i ? ", \"" : " \"") + m_settings[i].first + "\": " + std::to_string(m_settings[i].second);
+
+      json += " },\n  \"totals\": " + ToJson(s.totals) + ",\n  \"reader\": " + ToJson(s.reader) + ",\n  \"workers\": [";
+
+      for (size_t i = 0; i < s.workers.size(); ++i)
+         json += (i ? ",\n    " : "\n    ") + ToJson(s.workers[i]);
+
+      json += "\n  ],\n  \"blocks\": [";
+
+      for (size_t i = 0; i < m_blocks.size(); ++i)
+      {
+         const BlockRecord &b = m_blocks[i];
+
+         json += (i ? ",\n    " : "\n    ") + std::string("{ \"file\": ") + std::to_string(b.file) +
+            ", \"block\": " + std::to_string(b.block) + ", \"worker\": " + std::to_string(b.worker) +
+            ", \"counters\": " + ToJson(b.counters) + " }";
+      }
+
+      return json + "\n  ]\n}\n";
+   }
+
+   /**
+   * Returns the name of a phase, as used in the JSON dump.
+   * @param phase phase
+   * @return Phase name.
+   */
+   static const char *GetPhaseName (Phase phase)
+   {
+      static const char *names[numPhases] = { "read", "search", "merge", "sort", "preview", "queue_wait", "submit_wait" };
+      return names[phase];
+   }
+
+   /**
+   * Returns the time between two instants.
+   * @param from start
+   * @param to end
+   * @return Seconds between them.
+   */
+   static double Seconds (clock_type::time_point from, clock_type::time_point to)
+   {
+      return std::chrono::duration<double>(to - from).count();
+   }
+
+   /**
+   * Times consecutive phases: returns the time since the mark, and moves it to now.
+   * @param mark end of the previous phase
+   * @return Seconds since the mark.
+   */
+   static double Lap (clock_type::time_point &mark)
+   {
+      const clock_type::time_point now = clock_type::now();
+      const double seconds = Seconds(mark, now);
+
+      mark = now;
+      return seconds;
+   }
+
+private:
+   /**
+   * Counters of a searched block.
+   */
+   struct BlockRecord
+   {
+      size_t file;        /**< file index              */
+      uint32_t block;     /**< block index in the file */
+      size_t worker;      /**< worker that searched it */
+      Counters counters;  /**< block counters          */
+   };
+
+   static std::string Number (double value)
+   {
+      char buffer[32];
+      snprintf(buffer, sizeof(buffer), "%.6f", value);
+
+      return buffer;
+   }
+
+   static std::string ToJson (const Counters &c)
+   {
+      std::string json = "{ \"blocks\": " + std::to_string(c.blocks) + ", \"bytes\": " + std::to_string(c.bytes) +
+         ", \"candidates\": " + std::to_string(c.candidates) + ", \"results\": " + std::to_string(c.results) + ", \"seconds\": {";
+
+      for (int i = 0; i < numPhases; ++i)
+         json += (i ? ", \"" : " \"") + std::string(GetPhaseName(static_cast<Phase>(i))) + "\": " + Number(c.seconds[i]);
+
+      // throughput of the work itself, waits left out
+      const double busy = c.GetBusySeconds();
+      return json + " }, \"busy_bytes_per_second\": " + Number(busy > 0 ? c.bytes / busy : 0) + " }";
+   }
+
+   Summary m_summary;                  /**< counters so far                 */
+   std::vector<BlockRecord> m_blocks;  /**< counters of each block          */
+   std::vector<std::pair<std::string, uint64_t>> m_settings;  /**< settings */
+
+   clock_type::time_point m_start;     /**< when the search started         */
+   bool m_running;                     /**< the search is still going       */
+   double m_elapsed;                   /**< duration of a finished search   */
+
+   mutable std::mutex m_mutex;         /**< guards all of the above         */
+};
+
+#endif //~MONKEY_STATS_HPP
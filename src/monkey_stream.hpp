@@ -0,0 +1,451 @@
+/*
+ * Monkey-Moore - A simple and powerful relative search tool
+ * Copyright (C) 2007 Ricardo J. Ricken (Darkl0rd)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef MONKEY_STREAM_HPP
+#define MONKEY_STREAM_HPP
+
+#include <wx/wxprec.h>
+
+#ifdef __BORLANDC__
+   #pragma hdrstop
+#endif
+
+#ifndef WX_PRECOMP
+   #include <wx/wx.h>
+#endif
+
+#include <wx/file.h>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// each format is available when the build finds its library
+#ifdef MONKEY_WITH_ZLIB
+   #include <zlib.h>
+#endif
+
+#ifdef MONKEY_WITH_LZMA
+   #include <lzma.h>
+#endif
+
+#ifdef MONKEY_WITH_ZSTD
+   #include <zstd.h>
+#endif
+
+/**
+* Decompresses a file as it's read, front to back, so compressed dumps can be
+* searched without being extracted first. The format is told by the first bytes
+* of the file: gzip (concatenated members included), zlib, xz and zstd.
+* Errors (corrupt or truncated data) end the stream early, and IsOk() tells them
+* apart from its actual end.
+*/
+class CompressedInput
+{
+public:
+   enum Format { none, gzip, zlib, xz, zstd };
+
+   /**
+   * Constructor. Decompression starts at the current position of the file.
+   * @param file an opened file, which must outlive this object
+   * @param format compression format, as detected by Detect()
+   */
+   CompressedInput (wxFile &file, Format format) :
+   m_file(file), m_format(format), m_input(inputSize), m_inputPos(0), m_inputEnd(0), m_consumed(0),
+   m_eof(false), m_boundary(false), m_finished(false), m_ok(false), m_codec(0)
+   {
+      switch (m_format)
+      {
+#ifdef MONKEY_WITH_ZLIB
+         case gzip:
+         case zlib:
+         {
+            z_stream *z = new z_stream();
+
+            // 32 lets zlib tell gzip and zlib headers apart by itself
+            if (inflateInit2(z, 15 + 32) == Z_OK)
+            {
+               m_codec = z;
+               m_ok = true;
+            }
+            else
+               delete z;
+
+            break;
+         }
+#endif
+#ifdef MONKEY_WITH_LZMA
+         case xz:
+         {
+            lzma_stream *x = new lzma_stream();
+            *x = LZMA_STREAM_INIT;
+
+            if (lzma_stream_decoder(x, UINT64_MAX, LZMA_CONCATENATED) == LZMA_OK)
+            {
+               m_codec = x;
+               m_ok = true;
+            }
+            else
+               delete x;
+
+            break;
+         }
+#endif
+#ifdef MONKEY_WITH_ZSTD
+         case zstd:
+         {
+            ZSTD_DStream *d = ZSTD_createDStream();
+
+            if (d && !ZSTD_isError(ZSTD_initDStream(d)))
+            {
+               m_codec = d;
+               m_ok = true;
+            }
+            else
+               ZSTD_freeDStream(d);
+
+            break;
+         }
+#endif
+         default:
+            break;
+      }
+   }
+
+   /**
+   * Destructor. Releases the decoder.
+   */
+   ~CompressedInput ()
+   {
+      if (!m_codec)
+         return;
+
+      switch (m_format)
+      {
+#ifdef MONKEY_WITH_ZLIB
+         case gzip:
+         case zlib:
+            inflateEnd(static_cast<z_stream *>(m_codec));
+            delete static_cast<z_stream *>(m_codec);
+            break;
+#endif
+#ifdef MONKEY_WITH_LZMA
+         case xz:
+            lzma_end(static_cast<lzma_stream *>(m_codec));
+            delete static_cast<lzma_stream *>(m_codec);
+            break;
+#endif
+#ifdef MONKEY_WITH_ZSTD
+         case zstd:
+            ZSTD_freeDStream(static_cast<ZSTD_DStream *>(m_codec));
+            break;
+#endif
+         default:
+            break;
+      }
+   }
+
+   /**
+   * Finds out the compression format of a file, leaving it at its start.
+   * Formats this build can't decompress are reported as well.
+   * @param file an opened file
+   * @return The format, or none if the file isn't compressed.
+   */
+   static Format Detect (wxFile &file)
+   {
+      uint8_t magic[6] = { 0 };
+
+      file.Seek(0, wxFromStart);
+      const ssize_t read = file.Read(magic, sizeof(magic));
+      file.Seek(0, wxFromStart);
+
+      if (read >= 3 && magic[0] == 0x1f && magic[1] == 0x8b && magic[2] == 8)
+         return gzip;
+
+      if (read >= 6 && !memcmp(magic, "\xfd" "7zXZ\0", 6))
+         return xz;
+
+      if (read >= 4 && !memcmp(magic, "\x28\xb5\x2f\xfd", 4))
+         return zstd;
+
+      // the two bytes of a zlib header are common enough in raw data, so the
+      // stream must decompress too (when it can't be tried, it's left as is)
+      if (read >= 2 && (magic[0] & 0x0f) == 8 && (magic[0] >> 4) <= 7 && !(magic[1] & 0x20) &&
+         !(((magic[0] << 8) | magic[1]) % 31) && IsSupported(zlib))
+      {
+         bool valid;
+
+         {
+            CompressedInput probe(file, zlib);
+            std::vector<uint8_t> buffer(probeSize);
+
+            probe.Read(buffer.data(), buffer.size());
+            valid = probe.IsOk();
+         }
+
+         file.Seek(0, wxFromStart);
+
+         if (valid)
+            return zlib;
+      }
+
+      return none;
+   }
+
+   /**
+   * Finds out whether this build can decompress a format.
+   * @param format compression format
+   * @return True if the format is supported.
+   */
+   static bool IsSupported (Format format)
+   {
+      switch (format)
+      {
+#ifdef MONKEY_WITH_ZLIB
+         case gzip: case zlib: return true;
+#endif
+#ifdef MONKEY_WITH_LZMA
+         case xz: return true;
+#endif
+#ifdef MONKEY_WITH_ZSTD
+         case zstd: return true;
+#endif
+         default: return false;
+      }
+   }
+
+   /**
+   * Returns the name of a format.
+   * @param format compression format
+   * @return Format name.
+   */
+   static const wxChar *GetFormatName (Format format)
+   {
+      static const wxChar *names[] = { wxT("none"), wxT("gzip"), wxT("zlib"), wxT("xz"), wxT("zstd") };
+      return names[format];
+   }
+
+   /**
+   * Decompresses the next bytes of the stream.
+   * @param buffer where they're written to
+   * @param size number of bytes wanted
+   * @return Bytes decompressed, less than the ones wanted only at the end of the stream (or on errors).
+   */
+   size_t Read (void *buffer, size_t size)
+   {
+      uint8_t *out = static_cast<uint8_t *>(buffer);
+      size_t done = 0;
+
+      while (m_ok && !m_finished && done < size)
+      {
+         if (m_inputPos == m_inputEnd && !m_eof)
+            Refill();
+
+         // after a member or frame, the file may end (even right at the end of a chunk),
+         // or have zeros padding the last gzip member (ie: as written by tar)
+         if (m_boundary)
+         {
+            const size_t start = m_inputPos;
+
+            if (m_format == gzip)
+               while (m_inputPos < m_inputEnd && !m_input[m_inputPos])
+                  ++m_inputPos;
+
+            m_consumed += m_inputPos - start;
+
+            if (m_inputPos == m_inputEnd)
+            {
+               if (m_eof)
+                  Finish();
+
+               continue;
+            }
+         }
+
+         const size_t before = m_inputPos;
+         const size_t produced = Decode(out + done, size - done);
+
+         done += produced;
+
+         if (m_finished)
+            break;
+
+         m_consumed += m_inputPos - before;
+
+         // no way forward with the whole file read: it was cut short
+         if (!produced && m_inputPos == before && m_inputPos == m_inputEnd && m_eof)
+            m_ok = false;
+      }
+
+      return done;
+   }
+
+   /**
+   * Finds out whether the stream was decompressed with no errors so far.
+   * @return False if the data was corrupt or truncated, or the format isn't supported.
+   */
+   bool IsOk () const { return m_ok; }
+
+   /**
+   * Returns how much of the compressed file was decompressed, to report the progress.
+   * @return Compressed bytes consumed so far.
+   */
+   wxFileOffset GetInputPosition () const { return m_consumed; }
+
+   CompressedInput (const CompressedInput &) = delete;
+   CompressedInput &operator= (const CompressedInput &) = delete;
+
+private:
+   /**
+   * Reads the next chunk of compressed data.
+   */
+   void Refill ()
+   {
+      const ssize_t read = m_file.Read(m_input.data(), m_input.size());
+
+      m_inputPos = 0;
+      m_inputEnd = read > 0 ? static_cast<size_t>(read) : 0;
+      m_eof = m_inputEnd < m_input.size();
+   }
+
+   /**
+   * Runs the decoder over the compressed data at hand.
+   * @param out where decompressed bytes go
+   * @param size room available
+   * @return Bytes decompressed.
+   */
+   size_t Decode ([[maybe_unused]] uint8_t *out, [[maybe_unused]] size_t size)
+   {
+      switch (m_format)
+      {
+#ifdef MONKEY_WITH_ZLIB
+         case gzip:
+         case zlib:
+         {
+            z_stream *z = static_cast<z_stream *>(m_codec);
+
+            z->next_in = m_input.data() + m_inputPos;
+            z->avail_in = static_cast<uInt>(m_inputEnd - m_inputPos);
+            z->next_out = out;
+            z->avail_out = static_cast<uInt>(std::min<size_t>(size, UINT_MAX));
+
+            const uInt room = z->avail_out;
+            const int status = inflate(z, Z_NO_FLUSH);
+
+            if (m_inputPos != m_inputEnd - z->avail_in)
+               m_boundary = false;
+
+            m_inputPos = m_inputEnd - z->avail_in;
+
+            if (status == Z_STREAM_END)
+            {
+               // gzip members may follow each other (as written by pigz or cat)
+               if (m_format == gzip && (m_inputPos < m_inputEnd || !m_eof))
+               {
+                  inflateReset(z);
+                  m_boundary = true;
+               }
+               else
+                  Finish();
+            }
+            else if (status != Z_OK && status != Z_BUF_ERROR)
+               m_ok = false;
+
+            return room - z->avail_out;
+         }
+#endif
+#ifdef MONKEY_WITH_LZMA
+         case xz:
+         {
+            lzma_stream *x = static_cast<lzma_stream *>(m_codec);
+
+            x->next_in = m_input.data() + m_inputPos;
+            x->avail_in = m_inputEnd - m_inputPos;
+            x->next_out = out;
+            x->avail_out = size;
+
+            // concatenated streams only end once the decoder knows there's no more input
+            const lzma_ret status = lzma_code(x, m_eof ? LZMA_FINISH : LZMA_RUN);
+            m_inputPos = m_inputEnd - x->avail_in;
+
+            if (status == LZMA_STREAM_END)
+               Finish();
+            else if (status != LZMA_OK)
+               m_ok = false;
+
+            return size - x->avail_out;
+         }
+#endif
+#ifdef MONKEY_WITH_ZSTD
+         case zstd:
+         {
+            ZSTD_inBuffer in = { m_input.data(), m_inputEnd, m_inputPos };
+            ZSTD_outBuffer output = { out, size, 0 };
+
+            const size_t status = ZSTD_decompressStream(static_cast<ZSTD_DStream *>(m_codec), &output, &in);
+            m_inputPos = in.pos;
+
+            // frames may follow each other, so it only ends with the file (0 means a frame is complete)
+            if (ZSTD_isError(status))
+               m_ok = false;
+            else if (!status && m_inputPos == m_inputEnd && m_eof)
+               Finish();
+            else
+               m_boundary = !status;
+
+            return output.pos;
+         }
+#endif
+         default:
+            m_ok = false;
+            return 0;
+      }
+   }
+
+   /**
+   * Ends the stream after its last byte, ignoring anything after it.
+   */
+   void Finish ()
+   {
+      m_consumed = m_file.Tell();
+      m_finished = true;
+   }
+
+   enum
+   {
+      inputSize = 262144,  /**< compressed bytes read at once                 */
+      probeSize = 65536    /**< bytes a zlib stream must decompress to be one */
+   };
+
+   wxFile &m_file;
+   Format m_format;
+
+   std::vector<uint8_t> m_input;  /**< compressed data being decoded          */
+   size_t m_inputPos;             /**< next compressed byte to be decoded     */
+   size_t m_inputEnd;             /**< end of the compressed data at hand     */
+   wxFileOffset m_consumed;       /**< compressed bytes decoded so far        */
+
+   bool m_eof;                    /**< the whole file was read                */
+   bool m_boundary;               /**< a gzip member or zstd frame just ended */
+   bool m_finished;               /**< the stream ended                       */
+   bool m_ok;                     /**< no decompression errors so far         */
+   void *m_codec;                 /**< decoder state, depending on the format */
+};
+
+#endif //~MONKEY_STREAM_HPP
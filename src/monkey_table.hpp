@@ -177,37 +177,36 @@ public:
 
    /**
    * Fill the data table with the results obtained from the search.
-   * @param d search result
+   * @param table search result
    */
    template <typename _Type>
-   void InitTableData (const typename MonkeyMoore<_Type>::equivalency_type &d, bool isLittleEndian)
+   void InitTableData (const typename MonkeyMoore<_Type>::equivalency_type &table, bool isLittleEndian)
    {
       std::map<wxString, wxString> tbldata;
+      const auto d = table.expand();
 
       uint32_t numBytes = static_cast<uint32_t>(sizeof(_Type)) * 2;
       wxString bytefmt = wxString::Format(wxT("%%0%dX"), numBytes);
 
-      for (MonkeyMoore<_Type>::equivalency_type::const_iterator i = d.begin(); i != d.end(); i++)
+      for (auto i = d.begin(); i != d.end(); i++)
       {
          // when dealing with ASCII searches, we must generate the missing characters
          if (i->first == wxT('A') || i->first == wxT('a'))
          {
-            for (int j = 0, counter = i->second; j < 26; j++, counter++)
+            for (int j = 0; j < 26; j++)
             {
-               if (counter == std::numeric_limits<_Type>::max() + 1)
-                  counter = 0;
-
-               // swap the bytes according to the endianness of the results
-               _Type value = static_cast<_Type>(counter);
+               // values past the maximum wrap around (the cast takes care of it on any width),
+               // then the bytes are swapped according to the endianness of the results
+               _Type value = static_cast<_Type>(i->second + j);
                value = isLittleEndian ? swap_on_le<_Type>(value) : swap_on_be<_Type>(value);
 
-               tbldata[wxString::Format(bytefmt, value)] = wxString::Format(wxT("%c"), i->first + j);
+               tbldata[wxString::Format(bytefmt, value)] = wxString::Format(wxT("%c"), static_cast<wxChar>(i->first + j));
             }
          }
          else
          {
             _Type value = isLittleEndian ? swap_on_le<_Type>(i->second) : swap_on_be<_Type>(i->second);
-            tbldata[wxString::Format(bytefmt, value)] = wxString::Format(wxT("%c"), i->first);
+            tbldata[wxString::Format(bytefmt, value)] = wxString::Format(wxT("%c"), static_cast<wxChar>(i->first));
          }
       }
 
@@ -19,19 +19,6 @@
 #ifndef OBJECT_PRED_HPP
 #define OBJECT_PRED_HPP
 
-#include <wx/wxprec.h>
-
-#ifdef __BORLANDC__
-   #pragma hdrstop
-#endif
-
-#ifndef WX_PRECOMP
-   #include <wx/wx.h>
-#endif
-
-#include <string>
-#include <functional>
-
 /**
 * The find_last() function searches for the element denoted by v. If such
 * an element is found between start and end, the position of the last found
@@ -69,57 +56,63 @@ inline int count_begin (FwdIt start, const FwdIt end, const T &v)
    return n;
 }
 
+/*
+   The character predicates below only know about ASCII, like the standard ones on
+   the "C" locale, so they give the same answer for any character type (and on any
+   value, which isupper() and friends don't).
+*/
+
 /**
 * Unary predicate used to say wheter a character is uppercase or not.
 * @param c character to be tested
 * @return True if it's a uppercase character.
 */
-inline bool is_upper (const wxChar &c)
-{ return isupper(c) ? true : false; }
+inline constexpr bool is_upper (char32_t c)
+{ return c >= U'A' && c <= U'Z'; }
 
 /**
 * Unary predicate used to say wheter a character is lowercase or not.
 * @param c character to be tested
 * @return True if it's a lowercase character.
 */
-inline bool is_lower (const wxChar &c)
-{ return islower(c) ? true : false; }
+inline constexpr bool is_lower (char32_t c)
+{ return c >= U'a' && c <= U'z'; }
 
 /**
 * Unary predicate used to say whether a character is a digit or not.
 * @param c character to be tested
 * @return True if it's a digit.
 */
-inline bool is_digit (const wxChar &c)
-{ return isdigit(c) ? true : false; }
+inline constexpr bool is_digit (char32_t c)
+{ return c >= U'0' && c <= U'9'; }
 
 /**
 * Functor used to say whether a character is punctuation or not.
 */
-struct is_punct : public std::unary_function <wxChar, bool>
+struct is_punct
 {
    /**
    * Functor operator.
    * @param c character to be tested
    * @return True if it's a punctuation character.
    */
-   bool operator() (const wxChar &c) const {
-      return ispunct(c) ? true : false;
+   constexpr bool operator() (char32_t c) const {
+      return (c >= U'!' && c <= U'/') || (c >= U':' && c <= U'@') || (c >= U'[' && c <= U'`') || (c >= U'{' && c <= U'~');
    }
 };
 
 /**
 * Functor used to say wheter a character is a letter or not.
 */
-struct is_alpha : public std::unary_function <wxChar, bool>
+struct is_alpha
 {
    /**
    * Functor operator.
    * @param c character to be tested
    * @return True if it's a letter.
    */
-   bool operator() (const wxChar &c) const {
-      return isalpha(c) ? true : false;
+   constexpr bool operator() (char32_t c) const {
+      return is_upper(c) || is_lower(c);
    }
 };
 
@@ -0,0 +1,275 @@
+/*
+ * Monkey-Moore - A simple and powerful relative search tool
+ * Copyright (C) 2007 Ricardo J. Ricken (Darkl0rd)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+   Throughput benchmark for the Monkey-Moore core.
+
+   It generates reproducible corpora (the same seed always gives the same data)
+   and times MonkeyMoore<u8> and MonkeyMoore<u16> searches over them, for several
+   key lengths, numbers of wildcards and character set modes. One CSV line is
+   printed per case, so runs of different versions can be compared directly.
+
+   usage: monkey_bench [--size=MB] [--repeat=N] [--seed=N] [--corpus=name]
+*/
+
+#include "monkey_moore.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+   const char32_t wildcard = U'*';
+
+   /** 32 letters keyword; shorter keys are its prefixes, so planting it plants them all */
+   const u32string baseKeyword = U"monkeymooreisarelativesearchtool";
+
+   /** custom character set used on 8-bit data (a permuted alphabet) */
+   const u32string customSet8 = U"etaoinshrdlucmfwypvbgkqjxz";
+
+   /**
+   * Settings given on the command line.
+   */
+   struct BenchOptions
+   {
+      BenchOptions () : size(16), repeat(3), seed(1) { }
+
+      size_t size;       /**< corpus size, in MB            */
+      int repeat;        /**< runs per case (the best counts) */
+      unsigned seed;     /**< corpus generator seed          */
+      string corpus;     /**< only runs corpora with this name */
+   };
+
+   /**
+   * Encoding of a corpus: how letters and spaces are stored.
+   */
+   struct Encoding
+   {
+      const char *name;   /**< charset mode name                          */
+      u32string pattern;  /**< custom character set (empty on ASCII mode) */
+      unsigned letter;    /**< value of 'a', or of the first set character */
+      unsigned space;     /**< value of the space between words           */
+   };
+
+   /**
+   * Encodes a letter.
+   * @param enc corpus encoding
+   * @param c letter
+   * @return Its value in the corpus.
+   */
+   unsigned Encode (const Encoding &enc, char32_t c)
+   {
+      return enc.letter + static_cast<unsigned>(enc.pattern.empty() ? c - U'a' : enc.pattern.find(c));
+   }
+
+   /**
+   * Generates a corpus.
+   * @param kind random, text or dense
+   * @param enc encoding used by text corpora
+   * @param count number of values
+   * @param seed generator seed
+   * @return Corpus data.
+   */
+   template <typename _Type>
+   vector<_Type> Generate (const string &kind, const Encoding &enc, size_t count, unsigned seed)
+   {
+      mt19937 rng(seed);
+      vector<_Type> data(count);
+
+      if (kind == "random")
+      {
+         for (size_t i = 0; i < count; i++)
+            data[i] = static_cast<_Type>(rng());
+
+         return data;
+      }
+
+      // words of 2 to 10 random letters, separated by spaces
+      for (size_t i = 0; i < count; )
+      {
+         const size_t wordLength = 2 + rng() % 9;
+
+         for (size_t j = 0; j < wordLength && i < count; j++)
+            data[i++] = static_cast<_Type>(Encode(enc, static_cast<char32_t>(U'a' + rng() % 26)));
+
+         if (i < count)
+            data[i++] = static_cast<_Type>(enc.space);
+      }
+
+      // text has an occasional hit, dense data has one every few keyword lengths
+      const size_t interval = kind == "dense" ? baseKeyword.length() * 3 : 65536;
+
+      for (size_t i = rng() % interval; i + baseKeyword.length() <= count; i += interval)
+         for (size_t j = 0; j < baseKeyword.length(); j++)
+            data[i + j] = static_cast<_Type>(Encode(enc, baseKeyword[j]));
+
+      return data;
+   }
+
+   /**
+   * Builds a search key.
+   * @param length number of characters
+   * @param wildcards how many of them are wildcards (never the first or last one)
+   * @return Search key.
+   */
+   u32string MakeKeyword (size_t length, size_t wildcards)
+   {
+      u32string keyword = baseKeyword.substr(0, length);
+
+      for (size_t k = 1; k <= wildcards; k++)
+         keyword[length * k / (wildcards + 1)] = wildcard;
+
+      return keyword;
+   }
+
+   /**
+   * Runs every case over a corpus, printing one line for each.
+   * @param corpus corpus name
+   * @param data corpus data
+   * @param enc corpus encoding
+   * @param opt command line options
+   */
+   template <typename _Type>
+   void RunCases (const string &corpus, const vector<_Type> &data, const Encoding &enc, const BenchOptions &opt)
+   {
+      static const size_t keyLengths[] = { 4, 8, 16, 32 };
+      static const size_t wildcardCounts[] = { 0, 1, 3 };
+
+      const double megabytes = double(data.size() * sizeof(_Type)) / 1e6;
+
+      for (size_t kl = 0; kl < sizeof(keyLengths) / sizeof(keyLengths[0]); kl++)
+      {
+         for (size_t wc = 0; wc < sizeof(wildcardCounts) / sizeof(wildcardCounts[0]); wc++)
+         {
+            const size_t keyLength = keyLengths[kl];
+            const size_t wildcards = wildcardCounts[wc];
+
+            // a key needs at least three letters to be searched
+            if (keyLength < wildcards + 3)
+               continue;
+
+            MonkeyMoore<_Type> mm(MakeKeyword(keyLength, wildcards), wildcards ? wildcard : 0, enc.pattern);
+
+            double best = 0;
+            size_t hits = 0;
+
+            for (int run = 0; run < opt.repeat; run++)
+            {
+               const auto start = chrono::steady_clock::now();
+               hits = mm.search(data.data(), static_cast<long>(data.size())).size();
+               const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+               if (!run || seconds < best)
+                  best = seconds;
+            }
+
+            best = max(best, 1e-9);
+
+            printf("%s,%u,%s,%u,%u,%u,%u,%.6f,%.1f,%.1f\n", corpus.c_str(),
+               static_cast<unsigned>(sizeof(_Type) * 8), enc.name, static_cast<unsigned>(keyLength),
+               static_cast<unsigned>(wildcards), static_cast<unsigned>(data.size() * sizeof(_Type)),
+               static_cast<unsigned>(hits), best, megabytes / best, hits / best);
+
+            fflush(stdout);
+         }
+      }
+   }
+
+   /**
+   * Generates a corpus and runs every case over it, once per encoding.
+   * @param corpus corpus name (as printed)
+   * @param kind random, text or dense
+   * @param encodings encodings to run with
+   * @param opt command line options
+   */
+   template <typename _Type>
+   void RunCorpus (const string &corpus, const string &kind, const vector<Encoding> &encodings, const BenchOptions &opt)
+   {
+      if (!opt.corpus.empty() && opt.corpus != corpus)
+         return;
+
+      const size_t count = opt.size * 1024 * 1024 / sizeof(_Type);
+
+      for (auto enc = encodings.begin(); enc != encodings.end(); ++enc)
+         RunCases<_Type>(corpus, Generate<_Type>(kind, *enc, count, opt.seed), *enc, opt);
+   }
+}
+
+int main (int argc, char **argv)
+{
+   BenchOptions opt;
+
+   for (int i = 1; i < argc; i++)
+   {
+      if (!strncmp(argv[i], "--size=", 7))
+         opt.size = max(atoi(argv[i] + 7), 1);
+      else if (!strncmp(argv[i], "--repeat=", 9))
+         opt.repeat = max(atoi(argv[i] + 9), 1);
+      else if (!strncmp(argv[i], "--seed=", 7))
+         opt.seed = static_cast<unsigned>(strtoul(argv[i] + 7, 0, 10));
+      else if (!strncmp(argv[i], "--corpus=", 9))
+         opt.corpus = argv[i] + 9;
+      else
+      {
+         fprintf(stderr, "usage: %s [--size=MB] [--repeat=N] [--seed=N] [--corpus=name]\n", argv[0]);
+         return 1;
+      }
+   }
+
+   // 8-bit text is shifted ASCII; 16-bit text looks like Shift-JIS, with fullwidth
+   // letters on ASCII mode and hiragana values for the custom character set
+   vector<Encoding> encodings8, encodings16;
+
+   Encoding ascii8 = { "ascii", U"", 0x80, 0x20 };
+   Encoding custom8 = { "custom", customSet8, 0x40, 0x20 };
+   Encoding ascii16 = { "ascii", U"", 0x8281, 0x8140 };
+   Encoding custom16 = { "custom", U"", 0x829F, 0x8140 };
+
+   // hiragana, in the same order as their Shift-JIS values
+   for (char32_t c = 0x3041; c <= 0x3093; c++)
+      custom16.pattern += c;
+
+   // the keyword is spelled with custom set characters, so they stand for its letters
+   for (size_t i = 0; i < 26; i++)
+      custom16.pattern[i] = static_cast<char32_t>(U'a' + i);
+
+   encodings8.push_back(ascii8);
+   encodings8.push_back(custom8);
+   encodings16.push_back(ascii16);
+   encodings16.push_back(custom16);
+
+   printf("corpus,bits,charset,keylen,wildcards,bytes,hits,seconds,mb_per_s,hits_per_s\n");
+
+   RunCorpus<uint8_t>("random8", "random", encodings8, opt);
+   RunCorpus<uint8_t>("text8", "text", encodings8, opt);
+   RunCorpus<uint8_t>("dense8", "dense", encodings8, opt);
+   RunCorpus<uint16_t>("random16", "random", encodings16, opt);
+   RunCorpus<uint16_t>("sjis16", "text", encodings16, opt);
+   RunCorpus<uint16_t>("dense16", "dense", encodings16, opt);
+
+   return 0;
+}
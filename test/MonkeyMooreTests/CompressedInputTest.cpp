@@ -0,0 +1,210 @@
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "CppUnitTest.h"
+
+#include "../../src/monkey_stream.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace MonkeyMooreTests
+{
+   /**
+    * Set of tests to check the decompression of files as they're read, mostly
+    * of streams ending right where a chunk of compressed data ends.
+    */
+	TEST_CLASS(CompressedInputTest)
+	{
+   private:
+      /**
+       * Compressed bytes read at once by CompressedInput.
+       */
+      static const size_t chunkSize = 262144;
+
+      /**
+       * Creates data that doesn't compress.
+       * @param size The number of bytes
+       * @param seed The seed of the generator (the same one gives the same data)
+       * @return The data created
+       */
+      std::vector<uint8_t> createData(size_t size, uint32_t seed)
+      {
+         std::vector<uint8_t> data(size);
+
+         for (size_t i = 0; i < size; ++i)
+         {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            data[i] = static_cast<uint8_t>(seed >> 24);
+         }
+
+         return data;
+      }
+
+      /**
+       * Decompresses a file, checking that it's read in full and with no errors.
+       * @param file The contents of the compressed file
+       * @param format The format it must be detected as
+       * @param expected The data it must decompress to
+       */
+      void checkDecompression(const std::vector<uint8_t> &file, CompressedInput::Format format, const std::vector<uint8_t> &expected)
+      {
+         const std::string fileName = (std::filesystem::temp_directory_path() / "monkey_compressed_input_test.bin").string();
+
+         {
+            std::ofstream fileHandle(fileName, std::ios::binary | std::ios::trunc);
+            fileHandle.write(reinterpret_cast<const char*>(file.data()), file.size());
+         }
+
+         std::vector<uint8_t> data;
+         bool ok;
+
+         {
+            wxFile input(wxString(fileName.c_str()));
+            Assert::IsTrue(input.IsOpened(), L"Failed to create the compressed file");
+            Assert::AreEqual<int>(format, CompressedInput::Detect(input), L"Wrong format detected");
+
+            CompressedInput stream(input, format);
+            std::vector<uint8_t> buffer(65536);
+            size_t read;
+
+            do
+            {
+               read = stream.Read(buffer.data(), buffer.size());
+               data.insert(data.end(), buffer.begin(), buffer.begin() + read);
+            }
+            while (read == buffer.size());
+
+            ok = stream.IsOk();
+         }
+
+         std::remove(fileName.c_str());
+
+         Assert::IsTrue(ok, L"The stream was reported as corrupt or truncated");
+         Assert::AreEqual<size_t>(expected.size(), data.size(), L"Wrong number of bytes decompressed");
+         Assert::IsTrue(data == expected, L"Wrong data decompressed");
+      }
+
+#ifdef MONKEY_WITH_ZLIB
+      /**
+       * Compresses data into a gzip member, stored as is.
+       * @param data The data to be compressed
+       * @return The gzip member
+       */
+      std::vector<uint8_t> createGzip(const std::vector<uint8_t> &data)
+      {
+         z_stream z = z_stream();
+         Assert::AreEqual<int>(Z_OK, deflateInit2(&z, Z_NO_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY));
+
+         std::vector<uint8_t> member(deflateBound(&z, static_cast<uLong>(data.size())));
+
+         z.next_in = const_cast<Bytef *>(data.data());
+         z.avail_in = static_cast<uInt>(data.size());
+         z.next_out = member.data();
+         z.avail_out = static_cast<uInt>(member.size());
+
+         Assert::AreEqual<int>(Z_STREAM_END, deflate(&z, Z_FINISH));
+         member.resize(z.total_out);
+         deflateEnd(&z);
+
+         return member;
+      }
+
+      /**
+       * Creates a gzip member of the given compressed size.
+       * @param size The size of the member
+       * @param data Receives the data it decompresses to
+       * @return The gzip member
+       */
+      std::vector<uint8_t> createGzipOfSize(size_t size, std::vector<uint8_t> &data)
+      {
+         // stored data grows the member byte per byte, along with the headers of its blocks
+         std::vector<uint8_t> member = createGzip(data = createData(size, 1));
+
+         for (int i = 0; i < 4 && member.size() != size; ++i)
+            member = createGzip(data = createData(data.size() + size - member.size(), 1));
+
+         Assert::AreEqual<size_t>(size, member.size(), L"Failed to create a gzip member of the size needed");
+         return member;
+      }
+#endif
+
+	public:
+#ifdef MONKEY_WITH_ZLIB
+      /**
+       * Test for a gzip file whose only member ends with the first chunk of compressed data.
+       */
+      TEST_METHOD(Gzip_MemberEndsOnChunkBoundary)
+      {
+         std::vector<uint8_t> data;
+         const std::vector<uint8_t> file = createGzipOfSize(chunkSize, data);
+
+         checkDecompression(file, CompressedInput::gzip, data);
+      }
+
+      /**
+       * Test for a gzip file whose first member ends with the first chunk, followed by another one.
+       */
+      TEST_METHOD(Gzip_MembersAcrossChunkBoundary)
+      {
+         std::vector<uint8_t> data;
+         std::vector<uint8_t> file = createGzipOfSize(chunkSize, data);
+
+         const std::vector<uint8_t> second = createData(1000, 2);
+         const std::vector<uint8_t> member = createGzip(second);
+
+         file.insert(file.end(), member.begin(), member.end());
+         data.insert(data.end(), second.begin(), second.end());
+
+         checkDecompression(file, CompressedInput::gzip, data);
+      }
+
+      /**
+       * Test for gzip files padded with zeros after their last member, as tar does,
+       * within the same chunk and over the next ones.
+       */
+      TEST_METHOD(Gzip_ZeroPadding)
+      {
+         const std::vector<uint8_t> data = createData(50000, 3);
+         const std::vector<uint8_t> member = createGzip(data);
+
+         std::vector<uint8_t> file = member;
+         file.resize(member.size() + 10240 - member.size() % 10240, 0);
+
+         checkDecompression(file, CompressedInput::gzip, data);
+
+         file.resize(3 * chunkSize, 0);
+         checkDecompression(file, CompressedInput::gzip, data);
+      }
+#endif
+
+#ifdef MONKEY_WITH_ZSTD
+      /**
+       * Test for a zstd file whose only frame ends with the first chunk of compressed data.
+       */
+      TEST_METHOD(Zstd_FrameEndsOnChunkBoundary)
+      {
+         std::vector<uint8_t> file(ZSTD_compressBound(chunkSize));
+         std::vector<uint8_t> data = createData(chunkSize, 4);
+
+         // data that doesn't compress is stored as is, growing the frame byte per byte
+         size_t size = ZSTD_compress(file.data(), file.size(), data.data(), data.size(), 1);
+
+         for (int i = 0; i < 4 && !ZSTD_isError(size) && size != chunkSize; ++i)
+         {
+            data = createData(data.size() + chunkSize - size, 4);
+            size = ZSTD_compress(file.data(), file.size(), data.data(), data.size(), 1);
+         }
+
+         Assert::AreEqual<size_t>(chunkSize, size, L"Failed to create a zstd frame of the size needed");
+         file.resize(size);
+
+         checkDecompression(file, CompressedInput::zstd, data);
+      }
+#endif
+	};
+}
@@ -1,11 +1,13 @@
 #include <array>
+#include <cstring>
 #include <memory>
 #include <fstream>
+#include <map>
+#include <string>
 #include "CppUnitTest.h"
 
-#include <wx/filefn.h> 
-
-#include "..\..\src\monkey_moore.hpp"
+#include "../../src/monkey_moore.hpp"
+#include "../../src/monkey_multi.hpp"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -29,27 +31,30 @@ namespace MonkeyMooreTests
        * @param expected The expected results from that search
        */
       template <typename _Type> void checkResultMatch(
-         const std::pair<long, std::map<wxChar, _Type>>& result,
-         const std::pair<long, std::map<wxChar, _Type>>& expected)
+         const typename MonkeyMoore<_Type>::relative_type& result,
+         const typename MonkeyMoore<_Type>::relative_type& expected)
       {
          // Checks whether the result match has the expected address
          Assert::AreEqual<long>(result.first, expected.first,
-            wxT("Failed to return the correct address of a result match"));
+            L"Failed to return the correct address of a result match");
+
+         const auto resultValues = result.second.expand();
+         const auto expectedValues = expected.second.expand();
 
          // Checks whether both maps in the result match have the same number of elements
-         Assert::AreEqual<size_t>(expected.second.size(), result.second.size(),
-            wxT("Failed to return the correct number of values in a result match"));
+         Assert::AreEqual<size_t>(expectedValues.size(), resultValues.size(),
+            L"Failed to return the correct number of values in a result match");
 
-         for (const auto& kv : expected.second)
+         for (const auto& kv : expectedValues)
          {
             // Checks whether the current element in the map of expected values exists in the result
-            Assert::AreEqual<size_t>(1, result.second.count(kv.first),
-               wxT("Failed to return the correct values of a result match"));
+            Assert::AreEqual<size_t>(1, resultValues.count(kv.first),
+               L"Failed to return the correct values of a result match");
 
             // Checks whether the corresponding value of the current element in the
             // map of expected values matches the value in the result
-            Assert::AreEqual<_Type>(kv.second, result.second.at(kv.first),
-               wxT("Failed to return the correct values of a result match"));
+            Assert::AreEqual<_Type>(kv.second, resultValues.at(kv.first),
+               L"Failed to return the correct values of a result match");
          }
       }
 
@@ -60,20 +65,20 @@ namespace MonkeyMooreTests
        * @param expected The expected result set from that search
        */
       template <typename _Type> void checkSearchResults(
-         const std::vector<std::pair<long, std::map<wxChar, _Type>>>& results,
-         const std::vector<std::pair<long, std::map<wxChar, _Type>>>& expected)
+         const std::vector<typename MonkeyMoore<_Type>::relative_type>& results,
+         const std::vector<typename MonkeyMoore<_Type>::relative_type>& expected)
       {
          // Checks whether the result contains the expected number of matches
          Assert::AreEqual<size_t>(expected.size(), results.size(),
-            wxT("Failed to return correct number of results"));
+            L"Failed to return correct number of results");
 
-         for (auto i = 0; i < results.size(); ++i)
+         for (size_t i = 0; i < results.size(); ++i)
             checkResultMatch<_Type>(results[i], expected[i]);
       }
 
       /**
        * Creates a Monkey-Moore result match from the specified parameters (ASCII only).
-       * The result match is an instance of std::pair<long, std::map<wxChar, _Type>>.
+       * The result match is an instance of MonkeyMoore<_Type>::relative_type.
        * @tparam _Type The underlying data type used by Monkey-Moore to interpret data
        * @param offset The address where this match was found at
        * @param value_A The found value of 'A'
@@ -81,20 +86,16 @@ namespace MonkeyMooreTests
        * @return A pair containing the offset and matching values
        */
       template <typename _Type>
-      std::pair<long, std::map<wxChar, _Type>> createMatchAscii(long offset, _Type value_A, _Type value_a)
+      typename MonkeyMoore<_Type>::relative_type createMatchAscii(long offset, _Type value_A, _Type value_a)
       {
-         std::map<wxChar, _Type> matches;
-         matches.insert(std::make_pair('A', value_A));
-         matches.insert(std::make_pair('a', value_a));
-
-         return std::make_pair(offset, matches);
+         return std::make_pair(offset, MonkeyMoore<_Type>::equivalency_type::ascii(value_A, value_a));
       }
 
       template <typename _DataType>
       std::pair<size_t, std::shared_ptr<_DataType>> readDataFromFile(const std::string &fileName)
       {
          std::ifstream fileHandle(fileName, std::ios::binary | std::ios::ate);
-         Assert::IsFalse(!fileHandle == true, wxString::Format(wxT("Failed to open file needed in test: %s"), fileName).c_str());
+         Assert::IsFalse(!fileHandle == true, (L"Failed to open file needed in test: " + std::wstring(fileName.begin(), fileName.end())).c_str());
 
          auto fileSize = fileHandle.tellg();
          fileHandle.seekg(std::ios::beg);
@@ -105,14 +106,92 @@ namespace MonkeyMooreTests
          return std::make_pair(fileSize, data);
       }
 
+      /**
+       * Creates 8-bit data to search a keyword on: random values close to each other, with
+       * the keyword (or only its last characters) stored all over it, shifted by random amounts.
+       * @param keyword The keyword stored in the data
+       * @param size The number of values
+       * @param seed The seed of the generator (the same one gives the same data)
+       * @return The data created
+       */
+      std::vector<uint8_t> createRelativeData(const std::u32string &keyword, size_t size, uint32_t seed)
+      {
+         auto random = [&seed] ()
+         {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            return seed;
+         };
+
+         std::vector<uint8_t> data(size);
+
+         for (auto &value : data)
+            value = static_cast<uint8_t>(0x60 + random() % 8);
+
+         for (size_t pos = random() % 64; pos + keyword.length() <= size; pos += 1 + random() % (4 * keyword.length()))
+         {
+            const size_t from = random() % 3 ? 0 : random() % keyword.length();
+            const uint8_t shift = static_cast<uint8_t>(random());
+
+            for (size_t i = from; i < keyword.length(); ++i)
+               data[pos + i] = static_cast<uint8_t>(keyword[i] + shift);
+         }
+
+         return data;
+      }
+
+      /**
+       * Finds the matches of a keyword position by position, as a reference for the searches.
+       * Like them, a match hides the ones overlapping it by more than one value.
+       * @param keyword The keyword searched for (ASCII, matched by its differences alone)
+       * @param data The data searched on
+       * @return The offsets of the matches
+       */
+      std::vector<long> findRelative(const std::u32string &keyword, const std::vector<uint8_t> &data)
+      {
+         const long klen = static_cast<long>(keyword.length());
+         std::vector<long> offsets;
+
+         for (long pos = 0; pos + klen <= static_cast<long>(data.size()); )
+         {
+            long i = 1;
+
+            for (; i < klen && data[pos + i] - data[pos + i - 1] == static_cast<int>(keyword[i]) - static_cast<int>(keyword[i - 1]); ++i);
+
+            if (i == klen)
+            {
+               offsets.push_back(pos);
+               pos += klen - 1;
+            }
+            else ++pos;
+         }
+
+         return offsets;
+      }
+
+      /**
+       * Checks the offsets of the results of a search against the reference ones.
+       * @param results The results obtained from performing a search
+       * @param expected The expected offsets
+       * @param message The message shown on failure
+       */
+      void checkOffsets(const std::vector<MonkeyMoore<uint8_t>::relative_type> &results, const std::vector<long> &expected, const wchar_t *message)
+      {
+         Assert::AreEqual<size_t>(expected.size(), results.size(), message);
+
+         for (size_t i = 0; i < results.size(); ++i)
+            Assert::AreEqual<long>(expected[i], results[i].first, message);
+      }
+
 	public:
       /**
        * Test for a basic search using 8-bit data, on ASCII mode, with a single result.
        */
 		TEST_METHOD(Basic_8bit_ASCII_SingleResult)
 		{
-         const wxChar wildcard = wxT('');
-         const wxString keyword = "incredible";
+         const char32_t wildcard = 0;
+         const std::u32string keyword = U"incredible";
 
          // Matches:
          // 16 - 'a': 0x69, 'A': 0x49
@@ -135,8 +214,8 @@ namespace MonkeyMooreTests
        */
       TEST_METHOD(Basic_8bit_ASCII_MultipleResults)
       {
-         const wxChar wildcard = wxT('');
-         const wxString keyword = "grotesque";
+         const char32_t wildcard = 0;
+         const std::u32string keyword = U"grotesque";
 
          // Matches:
          // 11 - 'a': 0x64, 'A': 0x44
@@ -162,8 +241,8 @@ namespace MonkeyMooreTests
        */
       TEST_METHOD(Basic_8bit_ASCII_NoResults)
       {
-         const wxChar wildcard = wxT('');
-         const wxString keyword = "brotesque";
+         const char32_t wildcard = 0;
+         const std::u32string keyword = U"brotesque";
 
          // Matches: none
          std::string data = "wklv lv dq jurwhvtxh gdb, lq dq lwtyjxvzj zhhn, lq dq hyhq pruh itqvguswg bhdu.";
@@ -178,10 +257,521 @@ namespace MonkeyMooreTests
          checkSearchResults<uint8_t>(results, expected);
       }
 
+      /**
+       * Test for a basic search using 8-bit data, on ASCII mode, with a keyword containing
+       * repeated letters (which once caused the jump table to skip over the match).
+       */
+      TEST_METHOD(Basic_8bit_ASCII_RepeatedLetters)
+      {
+         const char32_t wildcard = 0;
+         const std::u32string keyword = U"coffee";
+
+         // Matches:
+         // 2 - 'a': 0x5F, 'A': 0x3F
+         std::string data = "ppamddcckdxhfsrbhmenfqger";
+         char *dataPtr = const_cast<char*>(data.data());
+
+         MonkeyMoore<uint8_t> moore(keyword, wildcard);
+         auto results = moore.search(reinterpret_cast<uint8_t*>(dataPtr), data.length());
+
+         // expected result
+         std::vector<MonkeyMoore<uint8_t>::relative_type> expected;
+         expected.push_back(createMatchAscii<uint8_t>(2, 0x3F, 0x5F));
+
+         checkSearchResults<uint8_t>(results, expected);
+      }
+
+      /**
+       * Test for a basic search using 8-bit data, on ASCII mode, with a keyword whose
+       * differences are wider than 8 bits, so it can't be matched.
+       */
+      TEST_METHOD(Basic_8bit_ASCII_KeywordWiderThanData)
+      {
+         const std::u32string keyword = U"a€bcd";
+
+         // Matches: none
+         std::string data = "!!!abcd!!!";
+         char *dataPtr = const_cast<char*>(data.data());
+
+         MonkeyMoore<uint8_t> moore(keyword);
+         auto results = moore.search_with(reinterpret_cast<uint8_t*>(dataPtr), data.length(), 0);
+
+         Assert::AreEqual<size_t>(0, results.size(), L"Failed to return no results");
+      }
+
+      /**
+       * Test for the Boyer-Moore loop alone (8-bit searches are prefiltered otherwise), on
+       * ASCII mode, with keywords containing repeated letters, against a search done position
+       * by position, so every jump it takes is checked not to skip over a match.
+       */
+      TEST_METHOD(Scalar_8bit_ASCII_RepeatedLetters)
+      {
+         const std::array<std::u32string, 5> keywords = { U"coffee", U"bookkeeper", U"mississippi", U"aaab", U"abab" };
+
+         for (size_t i = 0; i < keywords.size(); ++i)
+         {
+            const std::vector<uint8_t> data = createRelativeData(keywords[i], 20000, static_cast<uint32_t>(i + 1));
+            const std::vector<long> expected = findRelative(keywords[i], data);
+
+            Assert::IsTrue(expected.size() > 100, L"Too few matches in the data created");
+
+            MonkeyMoore<uint8_t> moore(keywords[i]);
+            auto results = moore.search_with(data.data(), static_cast<long>(data.size()), 0);
+
+            checkOffsets(results, expected, L"Failed to return the same matches as the reference search");
+         }
+      }
+
+      /**
+       * Test for the prefiltered search of 8-bit data, on ASCII mode, with each prefilter
+       * the processor runs (portable, SSE2 and AVX2), against a search done position by
+       * position and against the Boyer-Moore loop alone, also checking the matched values.
+       * The data lengths aren't multiples of the vector sizes, so their tails are checked too.
+       */
+      TEST_METHOD(Prefilter_8bit_ASCII_AllInstructionSets)
+      {
+         std::vector<delta_scan_type> scans = { delta_scan_scalar };
+
+#ifdef MM_SIMD_X86
+         bool avx2, sse2;
+         detect_simd_support(avx2, sse2);
+
+         if (sse2)
+            scans.push_back(delta_scan_sse2);
+
+         if (avx2)
+            scans.push_back(delta_scan_avx2);
+#endif
+
+         const std::array<std::u32string, 4> keywords = { U"grotesque", U"coffee", U"abab", U"by" };
+         const std::array<size_t, 3> sizes = { 20000, 4099, 45 };
+
+         for (size_t i = 0; i < keywords.size(); ++i)
+         {
+            for (size_t size : sizes)
+            {
+               std::vector<uint8_t> data = createRelativeData(keywords[i], size, static_cast<uint32_t>(7 * i + size));
+
+               // a match right at the end
+               for (size_t j = 0; j < keywords[i].length(); ++j)
+                  data[size - keywords[i].length() + j] = static_cast<uint8_t>(keywords[i][j] - 0x20);
+
+               const std::vector<long> expected = findRelative(keywords[i], data);
+
+               MonkeyMoore<uint8_t> moore(keywords[i]);
+               auto reference = moore.search_with(data.data(), static_cast<long>(size), 0);
+
+               for (auto scan : scans)
+               {
+                  auto results = moore.search_with(data.data(), static_cast<long>(size), scan);
+
+                  checkOffsets(results, expected, L"Failed to return the same matches as the reference search");
+                  Assert::IsTrue(results == reference, L"Failed to return the same values as the Boyer-Moore loop");
+               }
+            }
+         }
+      }
+
+      /**
+       * Test for a search with several keywords at once using 8-bit data, on ASCII mode,
+       * checking both the keyword index and the values of each result.
+       */
+      TEST_METHOD(Multi_8bit_ASCII_MultipleKeywords)
+      {
+         const char32_t wildcard = 0;
+         const std::vector<std::u32string> keywords = { U"grotesque", U"this", U"even" };
+
+         // Matches:
+         //  0 - "this"      'a': 0x64, 'A': 0x44
+         // 11 - "grotesque" 'a': 0x64, 'A': 0x44
+         // 32 - "grotesque" 'a': 0x66, 'A': 0x46
+         // 54 - "even"      'a': 0x64, 'A': 0x44
+         // 64 - "grotesque" 'a': 0x63, 'A': 0x43
+         std::string data = "wklv lv dq jurwhvtxh gdb, lq dq lwtyjxvzj zhhn, lq dq hyhq pruh itqvguswg bhdu.";
+         char *dataPtr = const_cast<char*>(data.data());
+
+         MonkeyMooreMulti<uint8_t> moore(keywords, wildcard);
+         auto results = moore.search(reinterpret_cast<uint8_t*>(dataPtr), data.length());
+
+         const std::array<int, 5> expectedKeywords = { 1, 0, 0, 2, 0 };
+
+         std::vector<MonkeyMoore<uint8_t>::relative_type> expected;
+         expected.push_back(createMatchAscii<uint8_t>(0, 0x44, 0x64));
+         expected.push_back(createMatchAscii<uint8_t>(11, 0x44, 0x64));
+         expected.push_back(createMatchAscii<uint8_t>(32, 0x46, 0x66));
+         expected.push_back(createMatchAscii<uint8_t>(54, 0x44, 0x64));
+         expected.push_back(createMatchAscii<uint8_t>(64, 0x43, 0x63));
+
+         Assert::AreEqual<size_t>(expected.size(), results.size(),
+            L"Failed to return correct number of results");
+
+         for (size_t i = 0; i < results.size(); ++i)
+         {
+            Assert::AreEqual<int>(expectedKeywords[i], std::get<1>(results[i]),
+               L"Failed to return the correct keyword of a result match");
+
+            checkResultMatch<uint8_t>(std::make_pair(std::get<0>(results[i]), std::get<2>(results[i])), expected[i]);
+         }
+      }
+
+      /**
+       * Test for a search with several keywords at once using 8-bit data, on ASCII mode,
+       * where one of them has differences wider than 8 bits, so it can't be matched.
+       */
+      TEST_METHOD(Multi_8bit_ASCII_KeywordWiderThanData)
+      {
+         const std::vector<std::u32string> keywords = { U"this", U"a€", U"even" };
+
+         // Matches:
+         //  0 - "this" 'a': 0x64, 'A': 0x44
+         // 54 - "even" 'a': 0x64, 'A': 0x44
+         std::string data = "wklv lv dq jurwhvtxh gdb, lq dq lwtyjxvzj zhhn, lq dq hyhq pruh itqvguswg bhdu.";
+         char *dataPtr = const_cast<char*>(data.data());
+
+         MonkeyMooreMulti<uint8_t> moore(keywords);
+         auto results = moore.search(reinterpret_cast<uint8_t*>(dataPtr), data.length());
+
+         const std::array<int, 2> expectedKeywords = { 0, 2 };
+
+         std::vector<MonkeyMoore<uint8_t>::relative_type> expected;
+         expected.push_back(createMatchAscii<uint8_t>(0, 0x44, 0x64));
+         expected.push_back(createMatchAscii<uint8_t>(54, 0x44, 0x64));
+
+         Assert::AreEqual<size_t>(expected.size(), results.size(),
+            L"Failed to return correct number of results");
+
+         for (size_t i = 0; i < results.size(); ++i)
+         {
+            Assert::AreEqual<int>(expectedKeywords[i], std::get<1>(results[i]),
+               L"Failed to return the correct keyword of a result match");
+
+            checkResultMatch<uint8_t>(std::make_pair(std::get<0>(results[i]), std::get<2>(results[i])), expected[i]);
+         }
+      }
+
+      /**
+       * Test for a search using 16-bit data, on ASCII mode, with matches starting
+       * on both even and odd bytes, loading the values with and without swapping them.
+       */
+      TEST_METHOD(Lanes_16bit_ASCII_BothAlignments)
+      {
+         const std::u32string keyword = U"grotesque";
+
+         // Matches:
+         //  3 - 'a': 0x0164, 'A': 0x0144
+         // 24 - 'a': 0x0170, 'A': 0x0150
+         for (bool swap : { false, true })
+         {
+            std::vector<uint8_t> data(48, 0xff);
+
+            auto store = [&data, &keyword, swap] (size_t offset, uint16_t shift)
+            {
+               for (size_t i = 0; i < keyword.length(); ++i)
+               {
+                  uint16_t value = static_cast<uint16_t>(keyword[i] - U'a' + shift);
+
+                  if (swap)
+                     value = swap_always<uint16_t>(value);
+
+                  memcpy(data.data() + offset + i * sizeof(uint16_t), &value, sizeof(uint16_t));
+               }
+            };
+
+            store(3, 0x0164);
+            store(24, 0x0170);
+
+            MonkeyMoore<uint16_t> moore(keyword);
+            auto results = moore.search_lanes(data.data(), data.size(), swap);
+
+            std::vector<MonkeyMoore<uint16_t>::relative_type> expected;
+            expected.push_back(createMatchAscii<uint16_t>(3, 0x0144, 0x0164));
+            expected.push_back(createMatchAscii<uint16_t>(24, 0x0150, 0x0170));
+
+            checkSearchResults<uint16_t>(results, expected);
+         }
+      }
+
+      /**
+       * Test for a search using 16-bit data, on ASCII mode, loading the values in both
+       * byte orders at once, with a match stored in each of them.
+       */
+      TEST_METHOD(Lanes_16bit_ASCII_BothByteOrders)
+      {
+         const std::u32string keyword = U"grotesque";
+
+         // Matches:
+         //  6 - native order,  'a': 0x0164, 'A': 0x0144
+         // 29 - swapped order, 'a': 0x0170, 'A': 0x0150
+         std::vector<uint8_t> data(56, 0xff);
+
+         for (size_t i = 0; i < keyword.length(); ++i)
+         {
+            const uint16_t native = static_cast<uint16_t>(keyword[i] - U'a' + 0x0164);
+            const uint16_t swapped = swap_always<uint16_t>(static_cast<uint16_t>(keyword[i] - U'a' + 0x0170));
+
+            memcpy(data.data() + 6 + i * sizeof(uint16_t), &native, sizeof(uint16_t));
+            memcpy(data.data() + 29 + i * sizeof(uint16_t), &swapped, sizeof(uint16_t));
+         }
+
+         MonkeyMoore<uint16_t> moore(keyword);
+
+         std::vector<MonkeyMoore<uint16_t>::relative_type> results[2];
+         moore.search_lanes(data.data(), data.size(), both_orders, results);
+
+         std::vector<MonkeyMoore<uint16_t>::relative_type> expectedNative, expectedSwapped;
+         expectedNative.push_back(createMatchAscii<uint16_t>(6, 0x0144, 0x0164));
+         expectedSwapped.push_back(createMatchAscii<uint16_t>(29, 0x0150, 0x0170));
+
+         checkSearchResults<uint16_t>(results[0], expectedNative);
+         checkSearchResults<uint16_t>(results[1], expectedSwapped);
+      }
+
+      /**
+       * Test for a basic search using 32-bit data, on ASCII mode, with values crossing
+       * the 16-bit boundary within a match (so their differences don't fit in 16 bits
+       * before wrapping around) and matches close to the end of the data.
+       */
+      TEST_METHOD(Basic_32bit_ASCII_MultipleResults)
+      {
+         const std::u32string keyword = U"grotesque";
+
+         // Matches:
+         //  2 - 'a': 0x0000FFF8, 'A': 0x0000FFD8
+         // 15 - 'a': 0x7FFFFFF0, 'A': 0x7FFFFFD0
+         // 31 - 'a': 0x00000061, 'A': 0x00000041
+         std::vector<uint32_t> data(40, 0xDEADBEEF);
+
+         auto store = [&data, &keyword] (size_t offset, uint32_t shift)
+         {
+            for (size_t i = 0; i < keyword.length(); ++i)
+               data[offset + i] = keyword[i] - U'a' + shift;
+         };
+
+         store(2, 0x0000FFF8);
+         store(15, 0x7FFFFFF0);
+         store(31, 0x00000061);
+
+         MonkeyMoore<uint32_t> moore(keyword);
+         auto results = moore.search(data.data(), static_cast<long>(data.size()));
+
+         std::vector<MonkeyMoore<uint32_t>::relative_type> expected;
+         expected.push_back(createMatchAscii<uint32_t>(2, 0x0000FFD8, 0x0000FFF8));
+         expected.push_back(createMatchAscii<uint32_t>(15, 0x7FFFFFD0, 0x7FFFFFF0));
+         expected.push_back(createMatchAscii<uint32_t>(31, 0x00000041, 0x00000061));
+
+         checkSearchResults<uint32_t>(results, expected);
+      }
+
+      /**
+       * Test for a basic search using 32-bit data, on ASCII mode, with no results: the keyword
+       * is there, but as 16-bit values, and with one of its differences off by 0x10000.
+       */
+      TEST_METHOD(Basic_32bit_ASCII_NoResults)
+      {
+         const std::u32string keyword = U"grotesque";
+
+         std::vector<uint32_t> data(24, 0);
+
+         for (size_t i = 0; i < keyword.length(); ++i)
+         {
+            data[i] = static_cast<uint32_t>(keyword[i]) | (static_cast<uint32_t>(keyword[i]) << 16);
+            data[12 + i] = keyword[i] + (i >= 4 ? 0x10000 : 0);
+         }
+
+         MonkeyMoore<uint32_t> moore(keyword);
+         auto results = moore.search(data.data(), static_cast<long>(data.size()));
+
+         Assert::AreEqual<size_t>(0, results.size(), L"Failed to return no results");
+      }
+
+      /**
+       * Test for a search using 32-bit data, on ASCII mode, with matches starting on each
+       * of the four byte alignments, loading the values with and without swapping them.
+       */
+      TEST_METHOD(Lanes_32bit_ASCII_AllAlignments)
+      {
+         const std::u32string keyword = U"grotesque";
+
+         // Matches:
+         //   0 - 'a': 0x00010064, 'A': 0x00010044
+         //  41 - 'a': 0x12345678, 'A': 0x12345658
+         //  82 - 'a': 0x00000070, 'A': 0x00000050
+         // 123 - 'a': 0xFFFFFF00, 'A': 0xFFFFFEE0
+         const std::array<size_t, 4> offsets = { 0, 41, 82, 123 };
+         const std::array<uint32_t, 4> shifts = { 0x00010064, 0x12345678, 0x00000070, 0xFFFFFF00 };
+
+         for (bool swap : { false, true })
+         {
+            std::vector<uint8_t> data(168, 0xff);
+
+            for (size_t m = 0; m < offsets.size(); ++m)
+            {
+               for (size_t i = 0; i < keyword.length(); ++i)
+               {
+                  uint32_t value = keyword[i] - U'a' + shifts[m];
+
+                  if (swap)
+                     value = swap_always<uint32_t>(value);
+
+                  memcpy(data.data() + offsets[m] + i * sizeof(uint32_t), &value, sizeof(uint32_t));
+               }
+            }
+
+            MonkeyMoore<uint32_t> moore(keyword);
+            auto results = moore.search_lanes(data.data(), static_cast<long>(data.size()), swap);
+
+            std::vector<MonkeyMoore<uint32_t>::relative_type> expected;
+
+            for (size_t m = 0; m < offsets.size(); ++m)
+               expected.push_back(createMatchAscii<uint32_t>(static_cast<long>(offsets[m]), shifts[m] - 0x20, shifts[m]));
+
+            checkSearchResults<uint32_t>(results, expected);
+         }
+      }
+
+      /**
+       * Test for a search using 8-bit data, on a custom character set too sparse to be
+       * looked up directly (it has characters beyond 0xFFFF), so it's hashed instead.
+       */
+      TEST_METHOD(Charset_8bit_Sparse_MultipleResults)
+      {
+         const std::u32string charset = U"abcdefghij\U0001F600\U0001F601\U0001F602\u3042\u3044\u3046";
+         const std::u32string keyword = U"b\U0001F602\u3042j\u3046";
+
+         // every character is found at its own position, and the others aren't part of the set
+         charset_index index;
+         index.assign(std::vector<char32_t>(charset.begin(), charset.end()));
+
+         for (size_t i = 0; i < charset.length(); ++i)
+            Assert::AreEqual<int>(static_cast<int>(i), index[charset[i]], L"Failed to return the position of a character");
+
+         for (char32_t c : { U'k', U'\U0001F603', U'\u3048', U'\U0002F600' })
+            Assert::AreEqual<int>(0, index[c], L"Failed to leave out a character not in the set");
+
+         // Matches (the positions of the keyword are 1, 12, 13, 9 and 15):
+         //  5 - first character of the set: 0x40
+         // 20 - first character of the set: 0x90
+         std::vector<uint8_t> data(32, 0);
+         const std::array<uint8_t, 5> positions = { 1, 12, 13, 9, 15 };
+
+         for (size_t i = 0; i < positions.size(); ++i)
+         {
+            data[5 + i] = static_cast<uint8_t>(0x40 + positions[i]);
+            data[20 + i] = static_cast<uint8_t>(0x90 + positions[i]);
+         }
+
+         MonkeyMoore<uint8_t> moore(keyword, 0, charset);
+         auto results = moore.search(data.data(), static_cast<long>(data.size()));
+
+         const auto set = std::make_shared<const MonkeyMoore<uint8_t>::equivalency_type::charset_type>(charset.begin(), charset.end());
+
+         std::vector<MonkeyMoore<uint8_t>::relative_type> expected;
+         expected.push_back(std::make_pair(5L, MonkeyMoore<uint8_t>::equivalency_type::charset(set, 0x40)));
+         expected.push_back(std::make_pair(20L, MonkeyMoore<uint8_t>::equivalency_type::charset(set, 0x90)));
+
+         checkSearchResults<uint8_t>(results, expected);
+      }
+
+      /**
+       * Test for the hashed jump table used on 16 and 32-bit data against the direct one used
+       * on 8-bit data, for keys of several lengths (so tables of several sizes), looking up every
+       * difference two 16-bit values can have: the ones not in the key get the default jump.
+       */
+      TEST_METHOD(SkipTable_16bit_HashedAgainstDirect)
+      {
+         uint32_t seed = 1;
+
+         auto random = [&seed] ()
+         {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            return seed;
+         };
+
+         for (long klen : { 3, 8, 33, 100 })
+         {
+            skip_table<uint16_t, false> hashed;
+            skip_table<uint16_t, true> direct;
+
+            hashed.reset(klen);
+            direct.reset(klen);
+
+            // like the differences of a key, inserted from its end: small ones repeat
+            // (keeping their first jump), big ones spread all over the table
+            for (long i = klen - 2; i > 0; --i)
+            {
+               const int diff = random() % 2 ? static_cast<int>(random() % 16) - 8 : static_cast<int>(random() % 131071) - 65535;
+
+               hashed.insert(diff, static_cast<int>(klen - i - 1));
+               direct.insert(diff, static_cast<int>(klen - i - 1));
+            }
+
+            for (int diff = -65535; diff <= 65535; ++diff)
+               Assert::AreEqual<int>(direct[diff], hashed[diff], L"Failed to return the same jump as the direct table");
+         }
+      }
+
+      /**
+       * Test for the hashed jump table used on 32-bit data, with differences that all land on
+       * its last slot, so they're moved to the next free ones, wrapping around the table.
+       * Differences landing there that aren't in the key must still get the default jump.
+       */
+      TEST_METHOD(SkipTable_32bit_HashedCollisions)
+      {
+         const long klen = 8;  // a table of 16 slots
+
+         // the slot of a difference is given by the top 4 bits of its (multiplicative) hash
+         std::vector<int> colliding;
+
+         for (int diff = 0x10FFFF; colliding.size() < 10; diff = diff > 0 ? -diff : -diff + 1)
+            if ((static_cast<uint32_t>(diff) * 2654435769u) >> 28 == 15)
+               colliding.push_back(diff);
+
+         skip_table<uint32_t> hashed;
+         hashed.reset(klen);
+
+         std::map<int, int> expected;
+
+         for (int i = 0; i < klen - 2; ++i)
+         {
+            hashed.insert(colliding[i], i + 1);
+            expected[colliding[i]] = i + 1;
+         }
+
+         // a difference already in the table keeps its jump
+         hashed.insert(colliding[0], 6);
+
+         for (size_t i = 0; i < colliding.size(); ++i)
+         {
+            const int jump = expected.count(colliding[i]) ? expected[colliding[i]] : klen - 1;
+            Assert::AreEqual<int>(jump, hashed[colliding[i]], L"Failed to return the jump of a difference");
+         }
+
+         for (int diff = -1000; diff <= 1000; ++diff)
+            Assert::AreEqual<int>(klen - 1, hashed[diff], L"Failed to return the default jump of a difference not in the key");
+      }
+
+      /**
+       * Test for the equivalency of an 8-bit match, kept on the 32-bit type (as the results
+       * of searches over every width are) and narrowed back to its own width.
+       */
+      TEST_METHOD(Equivalency_8bit_ASCII_WidenAndNarrow)
+      {
+         const auto table = createMatchAscii<uint8_t>(0, 0xE0, 0xF0).second;
+
+         const equivalency_table<uint32_t> widened(table);
+         const auto values = widened.expand();
+
+         Assert::AreEqual<uint32_t>(0xE0, values.at(U'A'));
+         Assert::AreEqual<uint32_t>(0xF0, values.at(U'a'));
+         Assert::IsTrue(equivalency_table<uint8_t>(widened) == table);
+      }
+
       TEST_METHOD(Wildcard_8bit_ASCII_MultipleResults)
       {
-         const wxChar wildcard = wxT('*');
-         const wxString keyword = "Spira*";
+         const char32_t wildcard = U'*';
+         const std::u32string keyword = U"Spira*";
 
          //const std::array<std::string, 5> keywords = { "Spira*", "*ver", "Every**e", "Never", "h**e" };
          /*const int offsets[][] = { { 120, 306 },
@@ -210,5 +800,43 @@ namespace MonkeyMooreTests
 
          checkSearchResults<uint8_t>(results, expected);
       }
+
+      /**
+       * Test for a search using 32-bit data, on ASCII mode, with wildcards, whose values
+       * may be anything, including ones the other letters would never have.
+       */
+      TEST_METHOD(Wildcard_32bit_ASCII_MultipleResults)
+      {
+         const char32_t wildcard = U'*';
+         const std::u32string keyword = U"gro*es*ue";
+
+         // Matches:
+         //  3 - 'a': 0x00020061, 'A': 0x00020041
+         // 20 - 'a': 0x80000000, 'A': 0x7FFFFFE0
+         std::vector<uint32_t> data(36, 0x55555555);
+         const std::u32string plain = U"grotesque";
+
+         for (size_t i = 0; i < plain.length(); ++i)
+         {
+            data[3 + i] = plain[i] - U'a' + 0x00020061;
+            data[20 + i] = plain[i] - U'a' + 0x80000000;
+         }
+
+         data[3 + 3] = 0xFFFFFFFF;
+         data[20 + 6] = 0;
+
+         // not a match: a letter that isn't a wildcard is off by one
+         for (size_t i = 0; i < plain.length() && 29 + i < data.size(); ++i)
+            data[29 + i] = plain[i] - U'a' + (i == 2 ? 0x00000101 : 0x00000100);
+
+         MonkeyMoore<uint32_t> moore(keyword, wildcard);
+         auto results = moore.search(data.data(), static_cast<long>(data.size()));
+
+         std::vector<MonkeyMoore<uint32_t>::relative_type> expected;
+         expected.push_back(createMatchAscii<uint32_t>(3, 0x00020041, 0x00020061));
+         expected.push_back(createMatchAscii<uint32_t>(20, 0x7FFFFFE0, 0x80000000));
+
+         checkSearchResults<uint32_t>(results, expected);
+      }
 	};
 }
\ No newline at end of file
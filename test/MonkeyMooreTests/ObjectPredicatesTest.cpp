@@ -2,7 +2,7 @@
 #include <algorithm>
 #include "CppUnitTest.h"
 
-#include "..\..\src\object_pred.hpp"
+#include "../../src/object_pred.hpp"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -43,10 +43,10 @@ namespace MonkeyMooreTests
          std::string mixed = "aBCdefGHiJkLMNOPqrStuvwxYz";
 
          auto count = std::count_if(upperLetters.begin(), upperLetters.end(), is_upper);
-         Assert::AreEqual<int>(26, count, wxT("is_upper failed with upperLetters"));
+         Assert::AreEqual<int>(26, count, L"is_upper failed with upperLetters");
 
          count = std::count_if(lowerLetters.begin(), lowerLetters.end(), is_upper);
-         Assert::AreEqual<int>(0, count, wxT("is_upper failed with lowerLetters"));
+         Assert::AreEqual<int>(0, count, L"is_upper failed with lowerLetters");
 
          count = std::count_if(mixed.begin(), mixed.end(), is_upper);
          Assert::AreEqual<int>(12, count);
@@ -0,0 +1,159 @@
+/*
+ * Monkey-Moore - A simple and powerful relative search tool
+ * Copyright (C) 2007 Ricardo J. Ricken (Darkl0rd)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PORTABLE_CPPUNITTEST_H
+#define PORTABLE_CPPUNITTEST_H
+
+/*
+   Stand-in for the parts of Microsoft's CppUnitTestFramework used by the tests
+   in MonkeyMooreTests, so they build and run unchanged with other compilers.
+   Test methods register themselves when the program starts, and TestRunner.cpp
+   runs them. The Visual Studio project keeps using the real framework.
+*/
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Microsoft { namespace VisualStudio { namespace CppUnitTestFramework
+{
+   /**
+   * Thrown by a failed assertion.
+   */
+   struct AssertFailure
+   {
+      AssertFailure (const std::string &what) : message(what) { }
+
+      std::string message;
+   };
+
+   /**
+   * Assertions available to the test methods.
+   */
+   class Assert
+   {
+   public:
+      template <typename T>
+      static void AreEqual (const T &expected, const T &actual, const wchar_t *message = NULL)
+      {
+         if (!(expected == actual))
+         {
+            std::ostringstream what;
+            what << "expected <" << Printable(expected) << ">, got <" << Printable(actual) << ">";
+
+            Fail(what.str(), message);
+         }
+      }
+
+      static void IsTrue (bool condition, const wchar_t *message = NULL)
+      {
+         if (!condition)
+            Fail("condition is false", message);
+      }
+
+      static void IsFalse (bool condition, const wchar_t *message = NULL)
+      {
+         if (condition)
+            Fail("condition is true", message);
+      }
+
+      static void Fail (const wchar_t *message = NULL)
+      {
+         Fail("failed", message);
+      }
+
+   private:
+      static void Fail (const std::string &what, const wchar_t *message)
+      {
+         std::string text = what;
+
+         // messages are plain ASCII; anything else is only replaced, not converted
+         if (message)
+         {
+            text += ": ";
+
+            for (; *message; message++)
+               text += *message < 0x80 ? static_cast<char>(*message) : '?';
+         }
+
+         throw AssertFailure(text);
+      }
+
+      template <typename T> static const T &Printable (const T &value) { return value; }
+
+      static int Printable (const char &value) { return value; }
+      static int Printable (const signed char &value) { return value; }
+      static unsigned Printable (const unsigned char &value) { return value; }
+   };
+
+   namespace Detail
+   {
+      /**
+      * A registered test method.
+      */
+      struct TestEntry
+      {
+         const char *className;
+         const char *methodName;
+         void (*run) ();
+      };
+
+      inline std::vector<TestEntry> &Registry ()
+      {
+         static std::vector<TestEntry> tests;
+         return tests;
+      }
+
+      /**
+      * Adds a test method to the registry when it's constructed.
+      */
+      struct Registrar
+      {
+         Registrar (const char *className, const char *methodName, void (*run) ())
+         {
+            TestEntry entry = { className, methodName, run };
+            Registry().push_back(entry);
+         }
+      };
+   }
+
+   /**
+   * Base of every test class.
+   * @tparam _Class the test class
+   * @tparam _Name gives the test class name
+   */
+   template <class _Class, class _Name> class TestClass
+   {
+   protected:
+      typedef _Class self_type;
+
+      static const char *ClassName () { return _Name::Get(); }
+   };
+}}}
+
+#define TEST_CLASS(className) \
+   struct className##_Name { static const char *Get () { return #className; } }; \
+   class className : public ::Microsoft::VisualStudio::CppUnitTestFramework::TestClass<className, className##_Name>
+
+#define TEST_METHOD(methodName) \
+   static void methodName##_Run () { self_type().methodName(); } \
+   inline static ::Microsoft::VisualStudio::CppUnitTestFramework::Detail::Registrar methodName##_Registrar { ClassName(), #methodName, &methodName##_Run }; \
+   void methodName ()
+
+#endif //~PORTABLE_CPPUNITTEST_H
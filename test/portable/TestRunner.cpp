@@ -0,0 +1,78 @@
+/*
+ * Monkey-Moore - A simple and powerful relative search tool
+ * Copyright (C) 2007 Ricardo J. Ricken (Darkl0rd)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+   Runs the tests registered through the portable CppUnitTest.h.
+
+   usage: monkey_tests [class name]...
+
+   With no arguments every test runs; otherwise only the ones in the given
+   classes do. The exit code is the number of failed tests (capped at 255).
+*/
+
+#include "CppUnitTest.h"
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+int main (int argc, char **argv)
+{
+   const std::vector<Detail::TestEntry> &tests = Detail::Registry();
+   int passed = 0, failed = 0;
+
+   for (size_t i = 0; i < tests.size(); i++)
+   {
+      bool selected = argc < 2;
+
+      for (int j = 1; j < argc && !selected; j++)
+         selected = !strcmp(argv[j], tests[i].className);
+
+      if (!selected)
+         continue;
+
+      try
+      {
+         tests[i].run();
+
+         printf("[ OK ] %s::%s\n", tests[i].className, tests[i].methodName);
+         passed++;
+         continue;
+      }
+      catch (const AssertFailure &e)
+      {
+         printf("[FAIL] %s::%s: %s\n", tests[i].className, tests[i].methodName, e.message.c_str());
+      }
+      catch (const std::exception &e)
+      {
+         printf("[FAIL] %s::%s: exception: %s\n", tests[i].className, tests[i].methodName, e.what());
+      }
+
+      failed++;
+   }
+
+   printf("%d passed, %d failed\n", passed, failed);
+
+   // asking for a class that has no tests is a mistake too
+   if (!passed && !failed)
+      return 1;
+
+   return failed < 255 ? failed : 255;
+}